@@ -0,0 +1,39 @@
+// src/common/byte_span.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Non-owning view over a contiguous byte range (std::span stand-in for C++17)
+struct ConstByteSpan {
+    const uint8_t* data;
+    size_t size;
+
+    ConstByteSpan() : data(nullptr), size(0) {}
+    ConstByteSpan(const uint8_t* d, size_t s) : data(d), size(s) {}
+    ConstByteSpan(const std::vector<uint8_t>& v) : data(v.data()), size(v.size()) {}
+
+    bool empty() const { return size == 0; }
+    const uint8_t* begin() const { return data; }
+    const uint8_t* end() const { return data + size; }
+
+    ConstByteSpan subspan(size_t offset, size_t count) const {
+        if (offset >= size) return ConstByteSpan(data + size, 0);
+        return ConstByteSpan(data + offset, count < size - offset ? count : size - offset);
+    }
+};
+
+struct ByteSpan {
+    uint8_t* data;
+    size_t size;
+
+    ByteSpan() : data(nullptr), size(0) {}
+    ByteSpan(uint8_t* d, size_t s) : data(d), size(s) {}
+    ByteSpan(std::vector<uint8_t>& v) : data(v.data()), size(v.size()) {}
+
+    bool empty() const { return size == 0; }
+    uint8_t* begin() const { return data; }
+    uint8_t* end() const { return data + size; }
+
+    operator ConstByteSpan() const { return ConstByteSpan(data, size); }
+};
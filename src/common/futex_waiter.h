@@ -0,0 +1,61 @@
+// src/common/futex_waiter.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Event count on a futex word. The notifying side pays one atomic load while
+// nobody sleeps and a FUTEX_WAKE only when a waiter is parked, so lock-free
+// queues can offer blocking pops without a mutex or condition variable.
+//
+// Waiter protocol: key = prepare_wait(); re-check the condition; then either
+// cancel_wait() or wait(key, timeout). Notifiers publish their data first.
+class FutexWaiter {
+public:
+    FutexWaiter() : epoch_(0), waiters_(0) {}
+
+    uint32_t prepare_wait() {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    void cancel_wait() {
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Sleep until notified after key was taken or the timeout expires
+    void wait(uint32_t key, std::chrono::nanoseconds timeout) {
+        if (timeout.count() > 0 && epoch_.load(std::memory_order_acquire) == key) {
+            struct timespec ts;
+            ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+            ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE,
+                    key, &ts, nullptr, 0);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify_all() {
+        // Pairs with the seq_cst increment in prepare_wait(): either the
+        // waiter sees our data on its re-check or we see the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE,
+                INT_MAX, nullptr, nullptr, 0);
+    }
+
+private:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                  "futex word must be a plain 32-bit integer");
+
+    std::atomic<uint32_t> epoch_;
+    std::atomic<uint32_t> waiters_;
+};
@@ -0,0 +1,192 @@
+// src/common/packet_pool.cpp
+#include "packet_pool.h"
+#include "logger.h"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+// PacketRef
+
+void PacketRef::add_ref(PacketSlot* slot) {
+    if (slot) {
+        slot->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void PacketRef::drop_ref(PacketSlot* slot) {
+    if (!slot || slot->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    if (slot->pool) {
+        slot->pool->release(slot->index);
+    } else {
+        delete[] slot->data;
+        delete slot;
+    }
+}
+
+PacketRef::PacketRef(const PacketRef& other)
+    : slot_(other.slot_), offset_(other.offset_), size_(other.size_) {
+    add_ref(slot_);
+}
+
+PacketRef::PacketRef(PacketRef&& other) noexcept
+    : slot_(other.slot_), offset_(other.offset_), size_(other.size_) {
+    other.slot_ = nullptr;
+    other.offset_ = 0;
+    other.size_ = 0;
+}
+
+PacketRef& PacketRef::operator=(const PacketRef& other) {
+    if (this != &other) {
+        add_ref(other.slot_);
+        drop_ref(slot_);
+        slot_ = other.slot_;
+        offset_ = other.offset_;
+        size_ = other.size_;
+    }
+    return *this;
+}
+
+PacketRef& PacketRef::operator=(PacketRef&& other) noexcept {
+    if (this != &other) {
+        drop_ref(slot_);
+        slot_ = other.slot_;
+        offset_ = other.offset_;
+        size_ = other.size_;
+        other.slot_ = nullptr;
+        other.offset_ = 0;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+PacketRef::~PacketRef() {
+    drop_ref(slot_);
+}
+
+PacketRef PacketRef::copy_of(ConstByteSpan bytes) {
+    PacketSlot* slot = new PacketSlot();
+    slot->data = new uint8_t[bytes.size > 0 ? bytes.size : 1];
+    slot->capacity = bytes.size;
+    slot->refs.store(1, std::memory_order_relaxed);
+    if (bytes.size > 0) {
+        std::memcpy(slot->data, bytes.data, bytes.size);
+    }
+    return PacketRef(slot, bytes.size);
+}
+
+PacketRef PacketRef::allocate(size_t capacity) {
+    PacketSlot* slot = new PacketSlot();
+    slot->data = new uint8_t[capacity > 0 ? capacity : 1];
+    slot->capacity = capacity;
+    slot->refs.store(1, std::memory_order_relaxed);
+    return PacketRef(slot, 0);
+}
+
+void PacketRef::resize(size_t size) {
+    size_ = size < capacity() ? size : capacity();
+}
+
+PacketRef PacketRef::subview(size_t offset, size_t length) const {
+    PacketRef view(*this);
+    if (offset >= size_) {
+        view.offset_ += size_;
+        view.size_ = 0;
+    } else {
+        view.offset_ += offset;
+        view.size_ = length < size_ - offset ? length : size_ - offset;
+    }
+    return view;
+}
+
+void PacketRef::reset() {
+    drop_ref(slot_);
+    slot_ = nullptr;
+    offset_ = 0;
+    size_ = 0;
+}
+
+// PacketPool
+
+PacketPool::PacketPool(size_t buffer_size, size_t buffer_count)
+    : buffer_size_(buffer_size), stride_(0), storage_(nullptr),
+      slots_(buffer_count), free_head_(0), free_next_(buffer_count),
+      available_(buffer_count), exhausted_(0) {
+
+    if (buffer_size == 0 || buffer_count == 0 || buffer_count >= UINT32_MAX) {
+        throw std::invalid_argument("Geçersiz packet pool parametreleri");
+    }
+
+    // Every buffer starts on its own cache line
+    stride_ = (buffer_size + kAlignment - 1) / kAlignment * kAlignment;
+    storage_ = static_cast<uint8_t*>(::operator new(stride_ * buffer_count,
+                                                    std::align_val_t(kAlignment)));
+
+    for (size_t i = 0; i < buffer_count; ++i) {
+        PacketSlot& slot = slots_[i];
+        slot.pool = this;
+        slot.data = storage_ + i * stride_;
+        slot.capacity = buffer_size;
+        slot.index = static_cast<uint32_t>(i);
+        free_next_[i].store(i + 1 < buffer_count ? static_cast<uint32_t>(i + 2) : 0,
+                            std::memory_order_relaxed);
+    }
+    free_head_.store(1, std::memory_order_release);
+}
+
+PacketPool::~PacketPool() {
+    size_t outstanding = slots_.size() - available_.load();
+    if (outstanding > 0) {
+        LOG_ERROR("Packet pool yok edilirken " + std::to_string(outstanding) + " buffer hâlâ kullanımda");
+    }
+    ::operator delete(storage_, std::align_val_t(kAlignment));
+}
+
+PacketRef PacketPool::acquire() {
+    uint64_t head = free_head_.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t top = static_cast<uint32_t>(head);
+        if (top == 0) {
+            exhausted_.fetch_add(1, std::memory_order_relaxed);
+            return PacketRef();
+        }
+
+        uint64_t next = free_next_[top - 1].load(std::memory_order_relaxed);
+        uint64_t replacement = ((head >> 32) + 1) << 32 | next;
+        if (free_head_.compare_exchange_weak(head, replacement,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+            PacketSlot* slot = &slots_[top - 1];
+            slot->refs.store(1, std::memory_order_relaxed);
+            available_.fetch_sub(1, std::memory_order_relaxed);
+            return PacketRef(slot, buffer_size_);
+        }
+    }
+}
+
+PacketRef PacketPool::copy(ConstByteSpan bytes) {
+    if (bytes.size > buffer_size_) {
+        return PacketRef();
+    }
+
+    PacketRef packet = acquire();
+    if (packet) {
+        std::memcpy(packet.mutable_data(), bytes.data, bytes.size);
+        packet.resize(bytes.size);
+    }
+    return packet;
+}
+
+void PacketPool::release(uint32_t index) {
+    uint64_t head = free_head_.load(std::memory_order_relaxed);
+    uint64_t replacement;
+    do {
+        free_next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        replacement = ((head >> 32) + 1) << 32 | (index + 1);
+    } while (!free_head_.compare_exchange_weak(head, replacement,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+    available_.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,121 @@
+// src/common/packet_pool.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <vector>
+#include "byte_span.h"
+
+class PacketPool;
+
+// Control block of one packet buffer. Pool buffers are recycled into their
+// pool when the last reference drops; heap buffers (pool == nullptr) are freed.
+struct PacketSlot {
+    std::atomic<uint32_t> refs;
+    PacketPool* pool;
+    uint8_t* data;
+    size_t capacity;
+    uint32_t index;
+
+    PacketSlot() : refs(0), pool(nullptr), data(nullptr), capacity(0), index(0) {}
+};
+
+// Reference-counted view into a packet buffer. Copies share the buffer, and
+// subview() narrows the view (e.g. past a header) without copying bytes.
+class PacketRef {
+public:
+    PacketRef() : slot_(nullptr), offset_(0), size_(0) {}
+    PacketRef(const PacketRef& other);
+    PacketRef(PacketRef&& other) noexcept;
+    PacketRef& operator=(const PacketRef& other);
+    PacketRef& operator=(PacketRef&& other) noexcept;
+    ~PacketRef();
+
+    // Heap-backed copy for callers without a pool
+    static PacketRef copy_of(ConstByteSpan bytes);
+
+    // Writable heap buffer of capacity bytes; the view is empty until resize()
+    static PacketRef allocate(size_t capacity);
+
+    const uint8_t* data() const { return slot_ ? slot_->data + offset_ : nullptr; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    ConstByteSpan span() const { return ConstByteSpan(data(), size_); }
+    const uint8_t* begin() const { return data(); }
+    const uint8_t* end() const { return data() + size_; }
+
+    // True if the handle owns a buffer (a failed acquire yields none)
+    explicit operator bool() const { return slot_ != nullptr; }
+
+    // Writable bytes while the buffer is being filled; only the sole owner
+    // may write, shared buffers are read only
+    uint8_t* mutable_data() { return slot_ ? slot_->data + offset_ : nullptr; }
+    size_t capacity() const { return slot_ ? slot_->capacity - offset_ : 0; }
+
+    // Set the view length after filling, at most capacity()
+    void resize(size_t size);
+
+    // True if no other handle shares the buffer, so it may be refilled
+    bool unique() const { return slot_ && slot_->refs.load(std::memory_order_acquire) == 1; }
+
+    // View of [offset, offset + length) sharing this buffer
+    PacketRef subview(size_t offset, size_t length = SIZE_MAX) const;
+
+    void reset();
+
+private:
+    friend class PacketPool;
+
+    PacketSlot* slot_;
+    size_t offset_;
+    size_t size_;
+
+    PacketRef(PacketSlot* slot, size_t size) : slot_(slot), offset_(0), size_(size) {}
+
+    static void add_ref(PacketSlot* slot);
+    static void drop_ref(PacketSlot* slot);
+};
+
+// Fixed set of equally sized, cache-line aligned packet buffers allocated up
+// front. acquire() and release are lock free, so the receive thread and the
+// frame consumer never contend on the allocator. The pool must outlive every
+// PacketRef it hands out.
+class PacketPool {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    PacketPool(size_t buffer_size, size_t buffer_count);
+    ~PacketPool();
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    // Buffer sized to buffer_size(); an empty handle if the pool is exhausted
+    PacketRef acquire();
+
+    // Acquire and fill with bytes; empty if exhausted or bytes do not fit
+    PacketRef copy(ConstByteSpan bytes);
+
+    // Get statistics
+    size_t get_buffer_size() const { return buffer_size_; }
+    size_t get_buffer_count() const { return slots_.size(); }
+    size_t get_available_count() const { return available_.load(std::memory_order_relaxed); }
+    uint64_t get_exhausted_count() const { return exhausted_.load(std::memory_order_relaxed); }
+
+private:
+    friend class PacketRef;
+
+    size_t buffer_size_;
+    size_t stride_;
+    uint8_t* storage_;
+    std::vector<PacketSlot> slots_;
+
+    // Treiber stack of free slots: low 32 bits index + 1 (0 = empty),
+    // high 32 bits a tag bumped on every update against ABA
+    std::atomic<uint64_t> free_head_;
+    std::vector<std::atomic<uint32_t>> free_next_;
+    std::atomic<size_t> available_;
+    std::atomic<uint64_t> exhausted_;
+
+    void release(uint32_t index);
+};
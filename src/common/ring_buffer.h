@@ -0,0 +1,378 @@
+// src/common/ring_buffer.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "futex_waiter.h"
+
+// Bounded lock-free rings for handing work between pipeline threads.
+// Capacity is rounded up to a power of two; producer and consumer indices
+// live on separate cache lines. A full ring rejects the push so the caller
+// picks the drop policy, except OverwriteRing, which drops its oldest value.
+// Consumers may block in pop_wait()/wait_for_data()
+// (and SpscRing producers in push_wait()); the other side only makes a
+// syscall when a thread is actually asleep.
+
+constexpr size_t kRingCacheLineSize = 64;
+
+inline size_t ring_capacity_for(size_t requested) {
+    if (requested == 0 || requested > (SIZE_MAX >> 1)) {
+        throw std::invalid_argument("Geçersiz ring kapasitesi");
+    }
+    size_t capacity = 1;
+    while (capacity < requested) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// Single producer, single consumer
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : capacity_(ring_capacity_for(capacity)), mask_(capacity_ - 1),
+          slots_(new T[capacity_]), head_(0), cached_tail_(0), tail_(0), cached_head_(0) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side
+    bool try_push(T value) {
+        return try_push_batch(&value, 1) == 1;
+    }
+
+    // Block while the ring is full; value is moved out only on success
+    bool push_wait(T& value, std::chrono::nanoseconds timeout) {
+        if (try_push_batch(&value, 1) == 1) {
+            return true;
+        }
+        uint32_t key = producer_waiter_.prepare_wait();
+        if (try_push_batch(&value, 1) == 1) {
+            producer_waiter_.cancel_wait();
+            return true;
+        }
+        producer_waiter_.wait(key, timeout);
+        return try_push_batch(&value, 1) == 1;
+    }
+
+    // Move up to count values in with one publish; returns how many fit
+    size_t try_push_batch(T* values, size_t count) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t free_slots = capacity_ - (tail - cached_head_);
+        if (free_slots < count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            free_slots = capacity_ - (tail - cached_head_);
+        }
+        size_t pushed = count < free_slots ? count : free_slots;
+        for (size_t i = 0; i < pushed; ++i) {
+            slots_[(tail + i) & mask_] = std::move(values[i]);
+        }
+        if (pushed > 0) {
+            tail_.store(tail + pushed, std::memory_order_release);
+            consumer_waiter_.notify_all();
+        }
+        return pushed;
+    }
+
+    // Consumer side
+    bool try_pop(T& value) {
+        return try_pop_batch(&value, 1) == 1;
+    }
+
+    size_t try_pop_batch(T* values, size_t max_count) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t available = cached_tail_ - head;
+        if (available < max_count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            available = cached_tail_ - head;
+        }
+        size_t popped = max_count < available ? max_count : available;
+        for (size_t i = 0; i < popped; ++i) {
+            values[i] = std::move(slots_[(head + i) & mask_]);
+        }
+        if (popped > 0) {
+            head_.store(head + popped, std::memory_order_release);
+            producer_waiter_.notify_all();
+        }
+        return popped;
+    }
+
+    bool pop_wait(T& value, std::chrono::nanoseconds timeout) {
+        return wait_for_data(timeout) && try_pop(value);
+    }
+
+    // Block until the ring is non-empty, the timeout expires or wake()
+    bool wait_for_data(std::chrono::nanoseconds timeout) {
+        if (!empty()) {
+            return true;
+        }
+        uint32_t key = consumer_waiter_.prepare_wait();
+        if (!empty()) {
+            consumer_waiter_.cancel_wait();
+            return true;
+        }
+        consumer_waiter_.wait(key, timeout);
+        return !empty();
+    }
+
+    // Wake blocked threads, e.g. on shutdown
+    void wake() {
+        consumer_waiter_.notify_all();
+        producer_waiter_.notify_all();
+    }
+
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    alignas(kRingCacheLineSize) std::atomic<size_t> head_;  // next slot to pop
+    size_t cached_tail_;                                    // consumer's copy of tail_
+    alignas(kRingCacheLineSize) std::atomic<size_t> tail_;  // next slot to fill
+    size_t cached_head_;                                    // producer's copy of head_
+    alignas(kRingCacheLineSize) FutexWaiter consumer_waiter_;
+    alignas(kRingCacheLineSize) FutexWaiter producer_waiter_;
+};
+
+// Single producer, single consumer for streams where only the newest values
+// matter: push() never fails, a full ring evicts its oldest value instead.
+// Slots carry sequence numbers as in MpscRing and pops claim their slot
+// with a CAS, because the producer pops too when it evicts.
+template <typename T>
+class OverwriteRing {
+public:
+    explicit OverwriteRing(size_t capacity)
+        : capacity_(ring_capacity_for(capacity)), mask_(capacity_ - 1),
+          slots_(new Slot[capacity_]), head_(0), tail_(0) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    OverwriteRing(const OverwriteRing&) = delete;
+    OverwriteRing& operator=(const OverwriteRing&) = delete;
+
+    // Producer side; returns how many old values were evicted
+    size_t push(T value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[tail & mask_];
+        size_t evicted = 0;
+        while (slot.sequence.load(std::memory_order_acquire) != tail) {
+            // Full. Evict the oldest unless the consumer has already
+            // claimed it and is still moving it out of this slot.
+            T oldest;
+            if (tail - head_.load(std::memory_order_relaxed) >= capacity_ && try_pop(oldest)) {
+                evicted++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        slot.value = std::move(value);
+        slot.sequence.store(tail + 1, std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_release);
+        consumer_waiter_.notify_all();
+        return evicted;
+    }
+
+    // Consumer side, one thread (and the producer while evicting)
+    bool try_pop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        do {
+            if (head == tail_.load(std::memory_order_acquire)) {
+                return false;
+            }
+        } while (!head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed));
+        Slot& slot = slots_[head & mask_];
+        value = std::move(slot.value);
+        slot.sequence.store(head + capacity_, std::memory_order_release);
+        return true;
+    }
+
+    size_t try_pop_batch(T* values, size_t max_count) {
+        size_t popped = 0;
+        while (popped < max_count && try_pop(values[popped])) {
+            popped++;
+        }
+        return popped;
+    }
+
+    bool wait_for_data(std::chrono::nanoseconds timeout) {
+        if (!empty()) {
+            return true;
+        }
+        uint32_t key = consumer_waiter_.prepare_wait();
+        if (!empty()) {
+            consumer_waiter_.cancel_wait();
+            return true;
+        }
+        consumer_waiter_.wait(key, timeout);
+        return !empty();
+    }
+
+    void wake() {
+        consumer_waiter_.notify_all();
+    }
+
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;  // index + 1 once filled, + capacity once free
+        T value;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(kRingCacheLineSize) std::atomic<size_t> head_;  // next slot to claim for a pop
+    alignas(kRingCacheLineSize) std::atomic<size_t> tail_;  // next slot to fill
+    alignas(kRingCacheLineSize) FutexWaiter consumer_waiter_;
+};
+
+// Multiple producers, single consumer. Producers claim slots with a CAS and
+// publish each slot through its own sequence number, so a stalled producer
+// delays only the consumer, never the other producers.
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t capacity)
+        : capacity_(ring_capacity_for(capacity)), mask_(capacity_ - 1),
+          slots_(new Slot[capacity_]), head_(0), tail_(0) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Producer side, any thread
+    bool try_push(T value) {
+        if (!push_one(value)) {
+            return false;
+        }
+        consumer_waiter_.notify_all();
+        return true;
+    }
+
+    size_t try_push_batch(T* values, size_t count) {
+        size_t pushed = 0;
+        while (pushed < count && push_one(values[pushed])) {
+            pushed++;
+        }
+        if (pushed > 0) {
+            consumer_waiter_.notify_all();
+        }
+        return pushed;
+    }
+
+    // Consumer side, one thread
+    bool try_pop(T& value) {
+        return try_pop_batch(&value, 1) == 1;
+    }
+
+    size_t try_pop_batch(T* values, size_t max_count) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t popped = 0;
+        while (popped < max_count) {
+            Slot& slot = slots_[head & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+                break;
+            }
+            values[popped++] = std::move(slot.value);
+            slot.sequence.store(head + capacity_, std::memory_order_release);
+            head++;
+        }
+        head_.store(head, std::memory_order_relaxed);
+        return popped;
+    }
+
+    bool pop_wait(T& value, std::chrono::nanoseconds timeout) {
+        return wait_for_data(timeout) && try_pop(value);
+    }
+
+    bool wait_for_data(std::chrono::nanoseconds timeout) {
+        if (ready()) {
+            return true;
+        }
+        uint32_t key = consumer_waiter_.prepare_wait();
+        if (ready()) {
+            consumer_waiter_.cancel_wait();
+            return true;
+        }
+        consumer_waiter_.wait(key, timeout);
+        return ready();
+    }
+
+    void wake() {
+        consumer_waiter_.notify_all();
+    }
+
+    // Approximate while producers are active
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(kRingCacheLineSize) std::atomic<size_t> head_;  // consumer position
+    alignas(kRingCacheLineSize) std::atomic<size_t> tail_;  // next slot to claim
+    alignas(kRingCacheLineSize) FutexWaiter consumer_waiter_;
+
+    // The consumer's next slot has been published
+    bool ready() const {
+        size_t head = head_.load(std::memory_order_relaxed);
+        return slots_[head & mask_].sequence.load(std::memory_order_acquire) == head + 1;
+    }
+
+    bool push_one(T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[tail & mask_];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(tail);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                tail = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
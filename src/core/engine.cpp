@@ -1,20 +1,66 @@
 // src/core/engine.cpp
 #include "engine.h"
 #include "../media/ffmpeg_encoder.h"
+#include "../media/ffmpeg_decoder.h"
 #include "../media/slicer.h"
 #include "../media/erasure_coder.h"
+#include "../media/fec_packetizer.h"
 #include "../network/sender_receiver.h"
 #include "../network/scheduler.h"
 #include "../network/path_monitor.h"
+#include "../network/fec_controller.h"
+#include "../network/congestion_controller.h"
+#include "../network/pacer.h"
+#include "../network/retransmit_cache.h"
+#include "../network/reactor.h"
+#include "../network/uring_receiver.h"
 #include "../transport/smart_collector.h"
+#include "../transport/packet_header.h"
+#include "../common/packet_pool.h"
+#include "../common/ring_buffer.h"
 #include "../common/logger.h"
 #include <opencv2/opencv.hpp>
 #include <thread>
 #include <chrono>
 #include <memory>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+// Pipeline stage payloads
+struct Engine::CapturedFrame {
+    cv::Mat image;
+    FFmpegEncoder::PixelFormat format = FFmpegEncoder::PixelFormat::BGR24;
+    std::chrono::steady_clock::time_point capture_time;
+};
+
+struct Engine::EncodedFrame {
+    std::vector<uint8_t> data;
+    bool keyframe = false;
+    std::chrono::steady_clock::time_point capture_time;
+};
+
+struct Engine::SendBatch {
+    uint32_t sequence_number = 0;
+    std::vector<std::vector<uint8_t>> data_chunks;
+    std::vector<PacketRef> parity;
+    std::chrono::steady_clock::time_point capture_time;
+};
+
+namespace {
+
+// Stage threads poll running_ at least this often
+constexpr std::chrono::milliseconds kStageWait(100);
+
+// The receive path looks for chunks to NACK at most this often
+constexpr std::chrono::milliseconds kNackInterval(5);
+
+} // namespace
 
 Engine::Engine(const EngineConfig& config) 
-    : config_(config), running_(false) {
+    : config_(config), running_(false), nack_sequence_(0), nack_path_(0), keyframe_request_sequence_(0),
+      have_keyframe_request_(false), last_keyframe_request_received_(0), have_receive_sequence_(false),
+      next_receive_sequence_(0), receive_frame_open_(false) {
     
     LOG_INFO("Nova Engine V3 başlatılıyor...");
     
@@ -31,8 +77,20 @@ void Engine::initialize_components() {
         // Initialize FFmpeg encoder (if available)
         FFmpegEncoder::EncoderConfig encoder_config(
             config_.width, config_.height, config_.fps, 
-            config_.bitrate_kbps, "libx264", "veryfast", "grain"
+            config_.bitrate_kbps * 1000, "libx264", "veryfast", "zerolatency"
         );
+        encoder_config.intra_refresh = config_.intra_refresh;
+        
+        // Losses are repaired on request, so periodic keyframes are only a
+        // fallback and can be rare
+        if (config_.gop_length > 0) {
+            encoder_config.gop_size = config_.gop_length;
+        } else if (config_.keyframe_requests) {
+            encoder_config.gop_size = config_.fps * 10;
+        }
+        if (config_.slice_streaming) {
+            encoder_config.slice_max_size = static_cast<int>(config_.max_chunk_size);
+        }
         encoder_ = std::make_unique<FFmpegEncoder>(encoder_config);
         
         // Try to initialize encoder, but don't fail if FFmpeg is not available
@@ -40,12 +98,45 @@ void Engine::initialize_components() {
             LOG_WARNING("FFmpeg encoder başlatılamadı. Video encoding devre dışı.");
         }
         
+        // Initialize FFmpeg decoder for the receive side
+        FFmpegDecoder::DecoderConfig decoder_config(
+            "h264", config_.decoder_threads, config_.decoder_frame_threading,
+            config_.slice_streaming
+        );
+        decoder_ = std::make_unique<FFmpegDecoder>(decoder_config);
+        if (!decoder_->initialize()) {
+            LOG_WARNING("FFmpeg decoder başlatılamadı. Sadece JPEG frame'ler gösterilecek.");
+        }
+        
         // Initialize slicer
         slicer_ = std::make_unique<Slicer>(config_.max_chunk_size);
         
-        // Initialize erasure coder
-        ErasureCoder::CodingParams coding_params(config_.k_chunks, config_.r_chunks);
-        erasure_coder_ = std::make_unique<ErasureCoder>(coding_params);
+        // Initialize erasure coder for the configured parameters
+        get_erasure_coder(config_.k_chunks, config_.r_chunks);
+        
+        // FEC symbols match the Slicer chunks so lost chunks can be rebuilt one to one
+        fec_packetizer_ = std::make_unique<FecPacketizer>(config_.max_chunk_size);
+        
+        // A block spanning depth frames completes depth-1 frame intervals
+        // later, so the depth is capped by the latency budget
+        int interleave_depth = std::max(1, config_.fec_interleave_depth);
+        int budget_frames = static_cast<int>(config_.fec_latency_budget_ms * config_.fps / 1000) + 1;
+        interleave_depth = std::min(interleave_depth, std::max(1, budget_frames));
+        fec_packetizer_->set_interleave_depth(interleave_depth);
+        if (interleave_depth > 1) {
+            if (config_.fec_latency_budget_ms >= config_.jitter_buffer_ms) {
+                LOG_WARNING("FEC gecikme bütçesi jitter buffer süresinden büyük, interleaved kurtarma geç kalabilir");
+            }
+            LOG_INFO("Interleaved FEC aktif (derinlik: " + std::to_string(interleave_depth) + " frame)");
+        }
+        
+        // FEC rate controller starts from the configured k/r
+        FecController::Config fec_config;
+        fec_config.default_k = config_.k_chunks;
+        fec_config.default_r = config_.r_chunks;
+        fec_config.keyframe_min_r = config_.r_chunks;
+        fec_config.interleave_depth = interleave_depth;
+        fec_controller_ = std::make_unique<FecController>(fec_config);
         
         // Initialize scheduler
         scheduler_ = std::make_unique<Scheduler>();
@@ -55,21 +146,118 @@ void Engine::initialize_components() {
             auto monitor = std::make_unique<PathMonitor>(path.ip, path.port);
             monitor->set_metrics_callback([this](const std::string& ip, uint16_t port, const PathMetrics& metrics) {
                 scheduler_->update_path_metrics(ip, port, metrics.rtt_ms, metrics.loss_rate, metrics.bandwidth_mbps);
+                fec_controller_->update_path_metrics(ip, port, metrics.loss_rate, metrics.mean_burst_length);
             });
             path_monitors_.push_back(std::move(monitor));
         }
         
+        // Buffers fit the largest chunk plus the largest header this FEC
+        // configuration produces; both ends run the same configuration, so
+        // anything longer is malformed and dropped on receive
+        const int max_fec_k = config_.adaptive_fec ? std::max(config_.k_chunks, fec_config.max_k)
+                                                   : config_.k_chunks;
+        const size_t max_datagram_size = config_.max_chunk_size +
+                                         max_packet_header_size(max_fec_k, interleave_depth);
+        
+        // Received datagrams live in pool buffers from the socket until the
+        // collector drops their frame
+        packet_pool_ = std::make_unique<PacketPool>(max_datagram_size, config_.packet_pool_size);
+        
+        // Send pipeline queues. Parity packets are copied out of the
+        // packetizer's arena so the next frame can be protected while this
+        // one is still being sent.
+        send_pool_ = std::make_unique<PacketPool>(max_datagram_size, (kSendQueueDepth + 2) * 128);
+        capture_queue_ = std::make_unique<OverwriteRing<CapturedFrame>>(kCaptureQueueDepth);
+        encoded_queue_ = std::make_unique<SpscRing<EncodedFrame>>(kEncodedQueueDepth);
+        send_queue_ = std::make_unique<SpscRing<SendBatch>>(kSendQueueDepth);
+        
+        // The target bitrate is shared out evenly until feedback says
+        // otherwise; feedback datagrams stay within a data chunk's size
+        CongestionController::Config cc_config;
+        const int64_t path_count = std::max<int64_t>(1, static_cast<int64_t>(config_.paths.size()));
+        cc_config.start_bitrate = static_cast<int64_t>(config_.bitrate_kbps) * 1000 / path_count;
+        cc_config.min_bitrate = static_cast<int64_t>(config_.min_bitrate_kbps) * 1000 / path_count;
+        cc_config.max_bitrate = static_cast<int64_t>(config_.max_bitrate_kbps) * 1000;
+        cc_config.fps = config_.fps;
+        
+        // Pacers start from the same share and follow the controller's target
+        Pacer::Config pacer_config;
+        pacer_config.rate_bps = static_cast<int64_t>(cc_config.start_bitrate * config_.pacing_factor);
+        pacer_config.min_rate_bps = static_cast<int64_t>(cc_config.min_bitrate * config_.pacing_factor);
+        pacer_config.burst_bytes = config_.pacing_burst_bytes > 0 ? config_.pacing_burst_bytes
+                                                                  : 4 * (config_.max_chunk_size + DataHeader::kSize);
+        
         // Initialize sender/receivers
         for (const auto& path : config_.paths) {
-            auto sender = std::make_unique<SenderReceiver>(path.ip, path.port);
+            auto sender = std::make_unique<SenderReceiver>(path.ip, path.port, max_datagram_size);
             if (!sender->initialize()) {
                 throw std::runtime_error("Sender/Receiver başlatılamadı: " + path.ip + ":" + std::to_string(path.port));
             }
+            if (config_.segmentation_offload) {
+                sender->enable_segmentation_offload();
+            }
             sender_receivers_.push_back(std::move(sender));
+            
+            // Feedback also carries the loss counts adaptive FEC follows,
+            // so it runs when either needs it
+            if (config_.congestion_control || config_.adaptive_fec) {
+                congestion_controllers_.push_back(std::make_unique<CongestionController>(cc_config));
+                feedback_reporters_.push_back(std::make_unique<FeedbackReporter>(
+                    config_.max_chunk_size + DataHeader::kSize));
+            }
+            if (config_.pacing) {
+                pacers_.push_back(std::make_unique<Pacer>(pacer_config));
+            }
+            scheduler_->add_path(path.ip, path.port);
         }
+        path_queues_.resize(sender_receivers_.size());
+        path_progress_.resize(sender_receivers_.size());
         
         // Initialize smart collector
         collector_ = std::make_unique<SmartCollector>(config_.jitter_buffer_ms);
+        collector_->set_max_chunk_size(config_.max_chunk_size);
+        collector_->set_slice_streaming(config_.slice_streaming);
+        if (config_.paths.size() > 1) {
+            collector_->set_reorder_window(config_.reorder_window_ms);
+        }
+        collector_->set_adaptive_playout(config_.adaptive_playout, config_.min_playout_delay_ms);
+        collector_->set_nack(config_.nack, config_.nack_delay_ms);
+        
+        // The resend cache covers a jitter buffer's worth of chunks at the
+        // highest bitrate; anything older would miss the far end's playout
+        if (config_.nack) {
+            RetransmitCache::Config cache_config;
+            const size_t buffered_bytes = static_cast<size_t>(config_.max_bitrate_kbps) * 1000 / 8 *
+                                          config_.jitter_buffer_ms / 1000;
+            cache_config.capacity = std::max<size_t>(256, 2 * buffered_bytes / config_.max_chunk_size);
+            cache_config.max_age_ms = config_.jitter_buffer_ms;
+            cache_config.rate_bps = std::max<int64_t>(
+                1, static_cast<int64_t>(config_.bitrate_kbps * 1000 * config_.retransmit_share));
+            retransmit_cache_ = std::make_unique<RetransmitCache>(cache_config);
+            nack_ = std::make_unique<NackHeader>();
+            received_nack_ = std::make_unique<NackHeader>();
+        }
+        
+        // Receive backend: io_uring if requested and supported, else epoll
+        if (config_.use_io_uring) {
+            uring_receiver_ = std::make_unique<UringReceiver>();
+            if (uring_receiver_->initialize()) {
+                for (size_t i = 0; i < sender_receivers_.size(); ++i) {
+                    uring_receiver_->add(sender_receivers_[i].get(), [this, i](ConstByteSpan datagram) {
+                        handle_datagram(datagram, i);
+                    });
+                }
+                if (config_.nack) {
+                    uring_receiver_->set_tick(kNackInterval, [this] { send_nacks(nack_path_); });
+                }
+            } else {
+                LOG_WARNING("io_uring kullanılamıyor, epoll reactor'a dönülüyor");
+                uring_receiver_.reset();
+            }
+        }
+        if (!uring_receiver_) {
+            create_reactor();
+        }
         
         LOG_INFO("Tüm bileşenler başarıyla başlatıldı");
         
@@ -79,6 +267,42 @@ void Engine::initialize_components() {
     }
 }
 
+void Engine::create_reactor() {
+    // One reactor thread owns every path socket and feeds the collector
+    // as soon as a socket turns readable
+    reactor_ = std::make_unique<Reactor>();
+    if (!reactor_->initialize()) {
+        throw std::runtime_error("Reactor başlatılamadı");
+    }
+    for (size_t i = 0; i < sender_receivers_.size(); ++i) {
+        SenderReceiver* socket = sender_receivers_[i].get();
+        // Zero-copy receive into pool buffers is worth more here than GRO,
+        // which would need a copy per segment
+        socket->disable_gro();
+        reactor_->add(socket->get_socket_fd(), [this, socket, i] {
+            socket->receive_packets(*packet_pool_, [this, i](PacketRef packet) {
+                handle_packet(packet, i);
+            });
+        });
+    }
+    // A gap at the end of a burst has no later packet to trigger its NACK
+    if (config_.nack && !reactor_->add_timer(kNackInterval, [this] { send_nacks(nack_path_); })) {
+        throw std::runtime_error("NACK zamanlayıcısı kurulamadı");
+    }
+}
+
+ErasureCoder& Engine::get_erasure_coder(int k, int r) {
+    // Coders are kept per (k, r) so switching between keyframe and P-frame
+    // parameters does not rebuild the decode tables
+    auto key = std::make_pair(k, r);
+    auto it = erasure_coders_.find(key);
+    if (it == erasure_coders_.end()) {
+        ErasureCoder::CodingParams coding_params(k, r);
+        it = erasure_coders_.emplace(key, std::make_unique<ErasureCoder>(coding_params)).first;
+    }
+    return *it->second;
+}
+
 void Engine::start() {
     if (running_.load()) {
         LOG_WARNING("Engine zaten çalışıyor");
@@ -93,16 +317,30 @@ void Engine::start() {
         monitor->start();
     }
     
-    // Start sender/receiver threads
+    // Start senders; the reactor does the receiving
     for (auto& sender : sender_receivers_) {
-        sender->start();
+        sender->start(false);
     }
     
-    // Start collector
+    // Start collector, then the receive backend that feeds it
     collector_->start();
+    if (uring_receiver_) {
+        uring_receiver_->start();
+        if (!uring_receiver_->is_running()) {
+            LOG_WARNING("io_uring receiver başlatılamadı, epoll reactor'a dönülüyor");
+            uring_receiver_.reset();
+            create_reactor();
+        }
+    }
+    if (reactor_) {
+        reactor_->start();
+    }
     
-    // Start main processing threads
-    video_thread_ = std::thread(&Engine::video_processing_loop, this);
+    // Start the send pipeline back to front, then the receive side
+    send_thread_ = std::thread(&Engine::send_loop, this);
+    packetize_thread_ = std::thread(&Engine::packetize_loop, this);
+    encode_thread_ = std::thread(&Engine::encode_loop, this);
+    capture_thread_ = std::thread(&Engine::capture_loop, this);
     network_thread_ = std::thread(&Engine::network_processing_loop, this);
     
     LOG_INFO("Engine başarıyla başlatıldı");
@@ -116,9 +354,14 @@ void Engine::stop() {
     LOG_INFO("Engine durduruluyor...");
     running_ = false;
     
-    // Stop threads
-    if (video_thread_.joinable()) {
-        video_thread_.join();
+    // Stop threads; blocked stages are woken so they notice running_
+    capture_queue_->wake();
+    encoded_queue_->wake();
+    send_queue_->wake();
+    for (std::thread* stage : {&capture_thread_, &encode_thread_, &packetize_thread_, &send_thread_}) {
+        if (stage->joinable()) {
+            stage->join();
+        }
     }
     if (network_thread_.joinable()) {
         network_thread_.join();
@@ -129,6 +372,13 @@ void Engine::stop() {
         monitor->stop();
     }
     
+    if (uring_receiver_) {
+        uring_receiver_->stop();
+    }
+    if (reactor_) {
+        reactor_->stop();
+    }
+    
     for (auto& sender : sender_receivers_) {
         sender->stop();
     }
@@ -140,7 +390,7 @@ void Engine::stop() {
     LOG_INFO("Engine durduruldu");
 }
 
-void Engine::video_processing_loop() {
+void Engine::capture_loop() {
     cv::VideoCapture cap(0);
     if (!cap.isOpened()) {
         LOG_ERROR("Kamera açılamadı");
@@ -151,130 +401,584 @@ void Engine::video_processing_loop() {
     cap.set(cv::CAP_PROP_FRAME_HEIGHT, config_.height);
     cap.set(cv::CAP_PROP_FPS, config_.fps);
     
-    cv::Mat frame;
-    uint32_t frame_sequence = 0;
+    // Ask for raw YUYV so the encoder converts straight to YUV420P; by
+    // default OpenCV converts every frame to BGR first
+    cap.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V'));
+    if (cap.set(cv::CAP_PROP_CONVERT_RGB, 0) && cap.get(cv::CAP_PROP_CONVERT_RGB) == 0) {
+        LOG_INFO("Kamera ham YUYV modunda");
+    }
+    
+    // Frames are paced against an absolute schedule, so processing time is
+    // never added on top of the frame interval. A camera that blocks in
+    // read() paces itself and the schedule only catches up.
+    const auto frame_interval = std::chrono::microseconds(1000000 / config_.fps);
+    auto next_capture = std::chrono::steady_clock::now();
     
     while (running_.load()) {
-        cap >> frame;
-        if (frame.empty()) {
+        CapturedFrame captured;
+        cap >> captured.image;
+        captured.capture_time = std::chrono::steady_clock::now();
+        if (captured.image.empty()) {
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            next_capture = std::chrono::steady_clock::now();
+            continue;
+        }
+        
+        if (captured.image.type() == CV_8UC2) {
+            captured.format = FFmpegEncoder::PixelFormat::YUYV;
+        } else if (captured.image.type() != CV_8UC3) {
+            // Raw mode handed out something else (e.g. MJPEG); let OpenCV decode
+            LOG_WARNING("Ham kamera formatı desteklenmiyor, BGR'ye dönülüyor");
+            cap.set(cv::CAP_PROP_CONVERT_RGB, 1);
             continue;
         }
         
+        // The encode stage skips to the newest frame; a full queue means it
+        // is stalled and the oldest waiting frame makes room for this one
+        if (capture_queue_->push(std::move(captured)) > 0) {
+            LOG_WARNING("Encode aşaması yetişemiyor, en eski frame atıldı");
+        }
+        
+        next_capture += frame_interval;
+        auto now = std::chrono::steady_clock::now();
+        if (next_capture > now) {
+            std::this_thread::sleep_until(next_capture);
+        } else if (now - next_capture > frame_interval) {
+            next_capture = now;
+        }
+    }
+    
+    cap.release();
+}
+
+void Engine::encode_loop() {
+    CapturedFrame pending[kCaptureQueueDepth];
+    uint64_t dropped_frames = 0;
+    
+    while (running_.load()) {
+        if (!capture_queue_->wait_for_data(kStageWait)) {
+            continue;
+        }
+        
+        // Drop oldest: only the newest captured frame is encoded
+        size_t count = capture_queue_->try_pop_batch(pending, kCaptureQueueDepth);
+        if (count == 0) {
+            continue;
+        }
+        if (count > 1) {
+            dropped_frames += count - 1;
+            LOG_DEBUG("Eski frame'ler atlandı, toplam: " + std::to_string(dropped_frames));
+        }
+        CapturedFrame& captured = pending[count - 1];
+        
         try {
-            // Convert frame to RGB
-            cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
-            
-            // Encode frame (if encoder is available)
-            std::vector<uint8_t> encoded_data;
+            // Encode frame (if encoder is available); the encoder reads the
+            // capture layout directly, so no colour pass happens here
+            cv::Mat& frame = captured.image;
+            EncodedFrame encoded;
+            encoded.capture_time = captured.capture_time;
             if (encoder_ && encoder_->is_initialized()) {
-                encoded_data = encoder_->encode_frame(
-                    frame.data, frame.cols, frame.rows
+                encoded.data = encoder_->encode_frame(
+                    frame.data, frame.cols, frame.rows,
+                    captured.format, static_cast<int>(frame.step)
                 );
+                encoded.keyframe = encoder_->is_keyframe();
             } else {
                 // Fallback: convert to JPEG
+                cv::Mat bgr = frame;
+                if (captured.format == FFmpegEncoder::PixelFormat::YUYV) {
+                    cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_YUYV);
+                }
                 std::vector<uchar> buffer;
                 std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, 80};
-                cv::imencode(".jpg", frame, buffer, params);
-                encoded_data.assign(buffer.begin(), buffer.end());
+                cv::imencode(".jpg", bgr, buffer, params);
+                encoded.data.assign(buffer.begin(), buffer.end());
             }
             
-            if (!encoded_data.empty()) {
-                // Slice encoded data
-                auto chunks = slicer_->slice_with_header(encoded_data, frame_sequence);
-                
-                // Add FEC chunks
-                auto fec_chunks = erasure_coder_->encode(encoded_data);
-                
-                // Send chunks through network
-                send_chunks(chunks, fec_chunks, frame_sequence);
-                
-                frame_sequence++;
+            // Encoded frames are never dropped; a slow network holds the
+            // encoder back and raw frames are dropped at capture instead
+            while (!encoded.data.empty() && running_.load() &&
+                   !encoded_queue_->push_wait(encoded, kStageWait)) {
             }
             
         } catch (const std::exception& e) {
             LOG_ERROR("Video işleme hatası: " + std::string(e.what()));
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / config_.fps));
+        for (size_t i = 0; i < count; ++i) {
+            pending[i] = CapturedFrame();
+        }
     }
+}
+
+void Engine::packetize_loop() {
+    uint32_t frame_sequence = 0;
     
-    cap.release();
+    while (running_.load()) {
+        EncodedFrame encoded;
+        if (!encoded_queue_->pop_wait(encoded, kStageWait)) {
+            continue;
+        }
+        
+        try {
+            SendBatch batch;
+            batch.sequence_number = frame_sequence;
+            batch.capture_time = encoded.capture_time;
+            
+            // Slice encoded data. NAL-aligned chunks carry whole slices, so
+            // the receiver can decode each one as soon as it is in; FEC then
+            // covers the padded layout rather than the raw bytes.
+            // The capture time rides along on the 90 kHz media clock for
+            // the receiver's playout clock.
+            auto capture_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                encoded.capture_time.time_since_epoch()).count();
+            uint32_t timestamp = static_cast<uint32_t>(capture_us * (kMediaClockRate / 1000) / 1000);
+            ConstByteSpan protected_data(encoded.data);
+            if (config_.slice_streaming) {
+                batch.data_chunks = slicer_->slice_nal_aligned(encoded.data, frame_sequence, fec_layout_, timestamp);
+                protected_data = ConstByteSpan(fec_layout_);
+            } else {
+                batch.data_chunks = slicer_->slice_with_header(encoded.data, frame_sequence, timestamp);
+            }
+            
+            // Pick k/r for this frame; keyframes are protected more heavily
+            int k = config_.k_chunks;
+            int r = config_.r_chunks;
+            if (config_.adaptive_fec) {
+                size_t data_symbols = fec_packetizer_->get_interleave_depth() > 1 ? 0 : batch.data_chunks.size();
+                FecController::Decision decision = fec_controller_->get_params(encoded.keyframe, data_symbols);
+                k = decision.k;
+                r = decision.r;
+            }
+            
+            // Data chunks go out while parity is computed
+            SendBatch parity_batch;
+            parity_batch.sequence_number = frame_sequence;
+            parity_batch.capture_time = encoded.capture_time;
+            while (running_.load() && !send_queue_->push_wait(batch, kStageWait)) {
+            }
+            
+            // Compute framed parity straight from the encoder output, then
+            // take it out of the arena before the next frame reuses it
+            fec_packetizer_->protect_frame(get_erasure_coder(k, r), protected_data, frame_sequence);
+            parity_batch.parity.reserve(fec_packetizer_->get_packet_count());
+            for (size_t i = 0; i < fec_packetizer_->get_packet_count(); ++i) {
+                ConstByteSpan packet = fec_packetizer_->get_packet(i);
+                PacketRef copy = send_pool_->copy(packet);
+                parity_batch.parity.push_back(copy ? std::move(copy) : PacketRef::copy_of(packet));
+            }
+            
+            frame_sequence++;
+            
+            while (!parity_batch.parity.empty() && running_.load() &&
+                   !send_queue_->push_wait(parity_batch, kStageWait)) {
+            }
+            
+        } catch (const std::exception& e) {
+            LOG_ERROR("Paketleme hatası: " + std::string(e.what()));
+        }
+    }
+}
+
+void Engine::send_loop() {
+    while (running_.load()) {
+        SendBatch batch;
+        if (!send_queue_->pop_wait(batch, kStageWait)) {
+            continue;
+        }
+        
+        try {
+            send_chunks(batch);
+            
+            if (!batch.data_chunks.empty() && batch.sequence_number % 300 == 0) {
+                auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - batch.capture_time);
+                LOG_DEBUG("Yakalama-gönderim gecikmesi: " + std::to_string(latency.count()) + "us");
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("Gönderme hatası: " + std::string(e.what()));
+        }
+    }
 }
 
 void Engine::network_processing_loop() {
+    // Datagrams reach the collector on the reactor thread; this loop only
+    // wakes when a frame completes (or periodically to check running_)
     while (running_.load()) {
         try {
-            // Process received chunks
-            for (auto& sender : sender_receivers_) {
-                auto received_chunks = sender->receive_chunks();
-                
-                for (const auto& chunk_data : received_chunks) {
-                    // Parse chunk header
-                    if (chunk_data.size() >= 12) {
-                        uint32_t sequence_number;
-                        uint16_t chunk_id, total_chunks, chunk_size;
-                        
-                        std::memcpy(&sequence_number, chunk_data.data(), 4);
-                        std::memcpy(&chunk_id, chunk_data.data() + 4, 2);
-                        std::memcpy(&total_chunks, chunk_data.data() + 6, 2);
-                        std::memcpy(&chunk_size, chunk_data.data() + 8, 2);
-                        
-                        // Add to collector
-                        collector_->add_chunk(sequence_number, chunk_id, total_chunks, 
-                                            std::vector<uint8_t>(chunk_data.begin() + 12, chunk_data.end()));
-                    }
-                }
+            if (!collector_->wait_for_complete_frames(std::chrono::milliseconds(100))) {
+                request_keyframe();
+                continue;
             }
             
             // Process complete frames from collector
-            auto complete_frames = collector_->get_complete_frames();
-            for (const auto& frame_data : complete_frames) {
-                process_complete_frame(frame_data);
+            auto complete_frames = collector_->pop_complete_frames();
+            for (const auto& frame : complete_frames) {
+                if (frame.frame_start) {
+                    // A frame that starts after a newer one was decoded is
+                    // too late; a skipped sequence number, or a streamed
+                    // frame that never ended, is a lost frame
+                    int32_t gap = static_cast<int32_t>(frame.sequence_number - next_receive_sequence_);
+                    if (have_receive_sequence_ && gap < 0) {
+                        continue;
+                    }
+                    if (have_receive_sequence_ && (gap > 0 || receive_frame_open_)) {
+                        decoder_->notify_loss();
+                    }
+                    have_receive_sequence_ = true;
+                    next_receive_sequence_ = frame.sequence_number + 1;
+                } else if (!receive_frame_open_ || frame.sequence_number + 1 != next_receive_sequence_) {
+                    // Later slices of a frame that was skipped or given up
+                    continue;
+                }
+                receive_frame_open_ = !frame.frame_end;
+                
+                process_complete_frame(frame.data.span(), frame.frame_start);
             }
             
+            request_keyframe();
+            
         } catch (const std::exception& e) {
             LOG_ERROR("Network işleme hatası: " + std::string(e.what()));
         }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 }
 
-void Engine::send_chunks(const std::vector<std::vector<uint8_t>>& data_chunks,
-                        const std::vector<std::vector<uint8_t>>& fec_chunks,
-                        uint32_t sequence_number) {
+void Engine::handle_datagram(ConstByteSpan datagram, size_t path_index) {
+    // Longer than anything the far end sends: malformed
+    if (datagram.size > packet_pool_->get_buffer_size()) {
+        return;
+    }
+    
+    // io_uring buffers go back to the kernel after the call; keep a pool copy
+    PacketRef packet = packet_pool_->copy(datagram);
+    if (packet) {
+        handle_packet(packet, path_index);
+    }
+}
+
+void Engine::handle_packet(const PacketRef& packet, size_t path_index) {
+    PacketType type;
+    if (!peek_packet_type(packet.data(), packet.size(), type)) {
+        return;
+    }
     
-    // Get best path from scheduler
-    auto path = scheduler_->get_next_path();
-    if (!path) {
+    if (type == PACKET_FEEDBACK) {
+        FeedbackHeader report;
+        if (path_index < congestion_controllers_.size() &&
+            FeedbackHeader::parse(packet.data(), packet.size(), report)) {
+            handle_feedback(report, path_index);
+        }
+        return;
+    }
+    if (type == PACKET_NACK) {
+        if (retransmit_cache_ && NackHeader::parse(packet.data(), packet.size(), *received_nack_)) {
+            handle_nack(*received_nack_, path_index);
+        }
+        return;
+    }
+    if (type == PACKET_KEYFRAME_REQUEST) {
+        KeyframeRequestHeader request;
+        if (KeyframeRequestHeader::parse(packet.data(), packet.size(), request)) {
+            handle_keyframe_request(request);
+        }
+        return;
+    }
+    
+    // Media arrivals are reported back to the sender on the same path
+    if (path_index < feedback_reporters_.size() &&
+        feedback_reporters_[path_index]->on_packet(packet.data(), packet.size(),
+                                                   std::chrono::steady_clock::now()) &&
+        feedback_reporters_[path_index]->build_report(feedback_buffer_)) {
+        sender_receivers_[path_index]->send_chunk(ConstByteSpan(feedback_buffer_));
+    }
+    
+    // Headers are parsed in place and payloads passed on as views of the
+    // same buffer
+    if (type == PACKET_FEC) {
+        FecHeader header;
+        if (FecHeader::parse(packet.data(), packet.size(), header)) {
+            collector_->add_fec_chunk(header, packet.subview(FecHeader::kSize));
+        }
+    } else if (type == PACKET_FEC_INTERLEAVED) {
+        InterleavedFecHeader header;
+        if (InterleavedFecHeader::parse(packet.data(), packet.size(), header)) {
+            collector_->add_interleaved_fec_chunk(header, packet.subview(header.size()));
+        }
+    } else if (type == PACKET_DATA) {
+        // Parse chunk header
+        DataHeader header;
+        if (DataHeader::parse(packet.data(), packet.size(), header)) {
+            // Add to collector
+            collector_->add_chunk(header, packet.subview(DataHeader::kSize));
+        }
+    }
+    
+    // Gaps are looked for as packets arrive, answered on the same path;
+    // the timer reuses the last media path
+    if (config_.nack) {
+        nack_path_ = path_index;
+        send_nacks(path_index);
+    }
+}
+
+void Engine::handle_nack(const NackHeader& nack, size_t path_index) {
+    size_t count = retransmit_cache_->fetch(nack, std::chrono::steady_clock::now(), retransmit_buffers_);
+    retransmit_datagrams_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        retransmit_datagrams_.emplace_back(retransmit_buffers_[i]);
+    }
+    if (!retransmit_datagrams_.empty()) {
+        sender_receivers_[path_index]->send_chunks(retransmit_datagrams_.data(), retransmit_datagrams_.size());
+    }
+}
+
+void Engine::send_nacks(size_t path_index) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_nack_check_ < kNackInterval) {
+        return;
+    }
+    last_nack_check_ = now;
+    
+    // NACKs stay within a data chunk's size, like feedback
+    size_t max_entries = NackHeader::max_entries(config_.max_chunk_size + DataHeader::kSize);
+    if (!collector_->collect_nacks(now, nack_->entries, max_entries)) {
+        return;
+    }
+    nack_->report_sequence = nack_sequence_++;
+    nack_buffer_.resize(nack_->size());
+    nack_->write(nack_buffer_.data());
+    sender_receivers_[path_index]->send_chunk(ConstByteSpan(nack_buffer_));
+}
+
+void Engine::request_keyframe() {
+    // Nothing to ask for before the stream has started, or while the
+    // decoder still has usable references
+    if (!config_.keyframe_requests || !have_receive_sequence_ || !decoder_->is_initialized() ||
+        !decoder_->is_waiting_for_keyframe()) {
+        return;
+    }
+    
+    // Ask again only once the keyframe asked for last had time to arrive
+    auto now = std::chrono::steady_clock::now();
+    auto interval = std::chrono::duration<double, std::milli>(
+        std::max<double>(config_.keyframe_request_interval_ms, 2.0 * collector_->get_nack_rtt_ms()));
+    if (now - last_keyframe_request_ < interval) {
+        return;
+    }
+    last_keyframe_request_ = now;
+    
+    // Sent on every path, any of which may be the lossy one
+    KeyframeRequestHeader request;
+    request.request_sequence = keyframe_request_sequence_++;
+    request.last_sequence = next_receive_sequence_ - 1;
+    uint8_t buffer[KeyframeRequestHeader::kSize];
+    request.write(buffer);
+    for (auto& sender_receiver : sender_receivers_) {
+        sender_receiver->send_chunk(ConstByteSpan(buffer, sizeof(buffer)));
+    }
+    LOG_DEBUG("Keyframe istendi, son frame: " + std::to_string(request.last_sequence));
+}
+
+void Engine::handle_keyframe_request(const KeyframeRequestHeader& request) {
+    if (!encoder_ || !encoder_->is_initialized()) {
+        return;
+    }
+    
+    // Copies from other paths carry a number already seen
+    if (have_keyframe_request_ &&
+        static_cast<int32_t>(request.request_sequence - last_keyframe_request_received_) <= 0) {
+        return;
+    }
+    have_keyframe_request_ = true;
+    last_keyframe_request_received_ = request.request_sequence;
+    
+    // The receiver repeats a request every interval until a keyframe gets
+    // through; half of that between IDRs tolerates jitter on the repeats
+    // while a burst of requests still costs one IDR
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_forced_keyframe_ < std::chrono::milliseconds(config_.keyframe_request_interval_ms / 2)) {
+        return;
+    }
+    last_forced_keyframe_ = now;
+    encoder_->force_keyframe();
+    LOG_DEBUG("Keyframe isteği alındı, IDR zorlanıyor");
+}
+
+void Engine::handle_feedback(const FeedbackHeader& report, size_t path_index) {
+    auto now = std::chrono::steady_clock::now();
+    CongestionController& controller = *congestion_controllers_[path_index];
+    controller.on_feedback(report, now);
+    
+    // Losses seen by the receiver reach the FEC controller through the path
+    // monitor, along with the estimated capacity and the round trip the
+    // scheduler weighs stripes by
+    if (path_index < path_monitors_.size()) {
+        if (controller.get_rtt_ms() > 0) {
+            path_monitors_[path_index]->update_rtt(controller.get_rtt_ms());
+        }
+        CongestionController::LossCounts counts = controller.take_loss_counts();
+        path_monitors_[path_index]->add_packet_counts(counts.received, counts.lost, counts.bursts);
+        path_monitors_[path_index]->update_bandwidth(controller.get_target_bitrate() / 1e6);
+    }
+    
+    // Without congestion control the controller only counts losses
+    if (!config_.congestion_control) {
+        return;
+    }
+    if (path_index < pacers_.size()) {
+        pacers_[path_index]->set_rate(static_cast<int64_t>(controller.get_target_bitrate() * config_.pacing_factor));
+    }
+    
+    update_target_bitrate(now);
+}
+
+void Engine::update_target_bitrate(std::chrono::steady_clock::time_point now) {
+    // Paths that have gone quiet carry nothing and add nothing
+    int64_t total = 0;
+    for (const auto& controller : congestion_controllers_) {
+        if (controller->has_recent_feedback(now)) {
+            total += controller->get_target_bitrate();
+        }
+    }
+    if (total <= 0) {
+        return;
+    }
+    
+    // Resends come on top of the media and are held to a share of it
+    if (retransmit_cache_) {
+        retransmit_cache_->set_rate(static_cast<int64_t>(total * config_.retransmit_share));
+    }
+    
+    if (!encoder_ || !encoder_->is_initialized()) {
+        return;
+    }
+    
+    // The target covers media and parity alike; the encoder gets the share
+    // left after the current P-frame FEC overhead
+    FecController::Decision fec = fec_controller_->get_params(false);
+    int64_t media = total * fec.k / (fec.k + fec.r);
+    
+    // Small corrections are not worth a rate control reset
+    int64_t current = encoder_->get_bitrate();
+    if (std::llabs(media - current) * 20 > current) {
+        encoder_->set_bitrate(static_cast<int>(media));
+        LOG_DEBUG("Hedef bitrate: " + std::to_string(media / 1000) + " kbps (toplam " +
+                  std::to_string(total / 1000) + " kbps)");
+    }
+}
+
+void Engine::send_chunks(const SendBatch& batch) {
+    // Data chunks then framed parity
+    std::vector<ConstByteSpan> datagrams;
+    datagrams.reserve(batch.data_chunks.size() + batch.parity.size());
+    for (const auto& chunk : batch.data_chunks) {
+        datagrams.emplace_back(chunk);
+    }
+    for (const auto& packet : batch.parity) {
+        datagrams.push_back(packet.span());
+    }
+    
+    // Stripe them over every active path; the scheduler's paths were added
+    // in sender_receivers_ order
+    if (!scheduler_->stripe(datagrams.size(), stripe_)) {
         LOG_WARNING("Aktif path bulunamadı");
         return;
     }
+    for (auto& queue : path_queues_) {
+        queue.clear();
+    }
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        if (stripe_[i] < path_queues_.size()) {
+            path_queues_[stripe_[i]].push_back(datagrams[i]);
+        }
+    }
     
-    // Find corresponding sender
-    for (auto& sender : sender_receivers_) {
-        if (sender->get_remote_ip() == path->ip && sender->get_remote_port() == path->port) {
-            // Send data chunks
-            for (const auto& chunk : data_chunks) {
-                sender->send_chunk(chunk);
+    // Each path is paced on its own: whichever has budget sends its next
+    // burst as one batch, and the thread sleeps only when none has
+    std::fill(path_progress_.begin(), path_progress_.end(), 0);
+    for (;;) {
+        bool pending = false;
+        bool progressed = false;
+        int64_t wake_at = std::numeric_limits<int64_t>::max();
+        
+        for (size_t index = 0; index < path_queues_.size(); ++index) {
+            const auto& queue = path_queues_[index];
+            size_t& done = path_progress_[index];
+            if (done >= queue.size()) {
+                continue;
             }
             
-            // Send FEC chunks
-            for (const auto& chunk : fec_chunks) {
-                sender->send_chunk(chunk);
+            size_t burst = queue.size() - done;
+            if (index < pacers_.size()) {
+                int64_t ready_at = 0;
+                burst = pacers_[index]->try_acquire(queue.data() + done, burst, ready_at);
+                if (burst == 0) {
+                    pending = true;
+                    wake_at = std::min(wake_at, ready_at);
+                    continue;
+                }
             }
             
+            size_t sent = sender_receivers_[index]->send_chunks(queue.data() + done, burst);
+            record_sent(index, queue.data() + done, sent);
+            progressed = true;
+            if (sent < burst) {
+                LOG_WARNING("Frame kısmen gönderildi: path " + std::to_string(index) + ", " +
+                            std::to_string(done + sent) + "/" + std::to_string(queue.size()));
+                done = queue.size();
+                continue;
+            }
+            done += sent;
+            pending = pending || done < queue.size();
+        }
+        
+        if (!pending) {
             break;
         }
+        if (!progressed) {
+            Pacer::sleep_until(wake_at);
+        }
+    }
+}
+
+void Engine::record_sent(size_t path_index, const ConstByteSpan* datagrams, size_t count) {
+    auto send_time = std::chrono::steady_clock::now();
+    if (retransmit_cache_) {
+        retransmit_cache_->store(datagrams, count, send_time);
+    }
+    
+    // The controller matches feedback against what actually left
+    if (path_index >= congestion_controllers_.size()) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t sequence_number;
+        uint16_t packet_id;
+        if (feedback_packet_id(datagrams[i].data, datagrams[i].size, sequence_number, packet_id)) {
+            congestion_controllers_[path_index]->on_packet_sent(sequence_number, packet_id,
+                                                                datagrams[i].size, send_time);
+        }
     }
 }
 
-void Engine::process_complete_frame(const std::vector<uint8_t>& frame_data) {
+void Engine::process_complete_frame(ConstByteSpan frame_data, bool frame_start) {
     try {
-        // Decode frame
-        std::vector<uchar> frame_buffer(frame_data.begin(), frame_data.end());
-        cv::Mat frame = cv::imdecode(frame_buffer, cv::IMREAD_COLOR);
+        cv::Mat frame;
+        
+        // Senders without FFmpeg fall back to JPEG frames
+        bool jpeg = frame_start && frame_data.size >= 2 && frame_data.data[0] == 0xFF && frame_data.data[1] == 0xD8;
+        if (jpeg) {
+            cv::Mat encoded(1, static_cast<int>(frame_data.size), CV_8UC1, const_cast<uint8_t*>(frame_data.data));
+            frame = cv::imdecode(encoded, cv::IMREAD_COLOR);
+        } else if (decoder_ && decoder_->is_initialized()) {
+            const AVFrame* picture = decoder_->decode_frame(frame_data.data, frame_data.size, frame_start);
+            int width = 0;
+            int height = 0;
+            if (picture && decoder_->convert_frame(picture, display_buffer_, width, height)) {
+                frame = cv::Mat(height, width, CV_8UC3, display_buffer_.data());
+            }
+        }
         
         if (!frame.empty()) {
             // Display frame
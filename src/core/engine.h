@@ -5,15 +5,35 @@
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <map>
+#include <utility>
+#include <chrono>
+#include "../common/byte_span.h"
 
 // Forward declarations
 class FFmpegEncoder;
+class FFmpegDecoder;
 class Slicer;
 class ErasureCoder;
+class FecPacketizer;
+class FecController;
 class Scheduler;
 class PathMonitor;
+class CongestionController;
+class FeedbackReporter;
+class Pacer;
+class RetransmitCache;
 class SenderReceiver;
 class SmartCollector;
+class Reactor;
+class UringReceiver;
+class PacketPool;
+class PacketRef;
+struct FeedbackHeader;
+struct NackHeader;
+struct KeyframeRequestHeader;
+template <typename T> class SpscRing;
+template <typename T> class OverwriteRing;
 
 struct PathConfig {
     std::string ip;
@@ -31,11 +51,44 @@ struct EngineConfig {
     size_t max_chunk_size;
     int k_chunks;
     int r_chunks;
-    uint32_t jitter_buffer_ms;
+    uint32_t jitter_buffer_ms;       // Upper bound of the playout delay, and how long incomplete frames are kept
+    bool segmentation_offload;       // UDP GSO/GRO when the kernel supports it (GRO with io_uring only)
+    bool use_io_uring;               // io_uring receive backend, epoll if unavailable
+    bool adaptive_fec;               // Retune k/r from path loss; k_chunks/r_chunks until first report
+    int fec_interleave_depth;        // Frames one FEC block may span (1 = per frame)
+    uint32_t fec_latency_budget_ms;  // Upper bound on extra recovery delay from interleaving
+    size_t packet_pool_size;         // Receive buffers shared by sockets and the collector
+    int decoder_threads;             // 0 = one per core
+    bool decoder_frame_threading;    // Frame threading: more throughput, more delay
+    bool intra_refresh;              // Rolling intra refresh instead of periodic IDRs
+    bool slice_streaming;            // NAL-aligned chunks; slices decoded as they arrive
+    bool congestion_control;         // Encoder bitrate follows receiver feedback; bitrate_kbps is the start
+    int min_bitrate_kbps;            // Bounds of the congestion controller target, media and FEC together
+    int max_bitrate_kbps;
+    bool pacing;                     // Spread each frame's datagrams instead of sending at line rate
+    double pacing_factor;            // Pacing rate as a multiple of the path's target bitrate
+    size_t pacing_burst_bytes;       // Bytes that may leave back to back (0 = four datagrams)
+    uint32_t reorder_window_ms;      // Multipath: how long a frame waits for older ones on slower paths
+    bool adaptive_playout;           // Release frames on a playout clock that follows measured jitter
+    uint32_t min_playout_delay_ms;   // Floor of the adaptive playout delay
+    bool nack;                       // Receiver NACKs missing chunks, sender resends them
+    uint32_t nack_delay_ms;          // How long a gap may be reordering before it is NACKed
+    double retransmit_share;         // Cap on the resend rate as a share of the target bitrate
+    bool keyframe_requests;          // Receiver asks for an IDR when it loses a reference
+    uint32_t keyframe_request_interval_ms;  // Least time between requests, and between forced IDRs
+    int gop_length;                  // Frames per IDR period / refresh sweep; 0 = 10 s with keyframe requests, else 1 s
     std::vector<PathConfig> paths;
     
     EngineConfig() : width(1280), height(720), fps(30), bitrate_kbps(3000),
-                     max_chunk_size(1000), k_chunks(8), r_chunks(2), jitter_buffer_ms(100) {}
+                     max_chunk_size(1000), k_chunks(8), r_chunks(2), jitter_buffer_ms(100),
+                     segmentation_offload(true), use_io_uring(false), adaptive_fec(true), fec_interleave_depth(1), fec_latency_budget_ms(50),
+                     packet_pool_size(4096), decoder_threads(0), decoder_frame_threading(false),
+                     intra_refresh(true), slice_streaming(true), congestion_control(true),
+                     min_bitrate_kbps(300), max_bitrate_kbps(8000), pacing(true),
+                     pacing_factor(2.5), pacing_burst_bytes(0), reorder_window_ms(50),
+                     adaptive_playout(true), min_playout_delay_ms(0), nack(true), nack_delay_ms(10),
+                     retransmit_share(0.25), keyframe_requests(true), keyframe_request_interval_ms(100),
+                     gop_length(0) {}
 };
 
 class Engine {
@@ -57,23 +110,96 @@ private:
     
     // Components
     std::unique_ptr<FFmpegEncoder> encoder_;
+    std::unique_ptr<FFmpegDecoder> decoder_;
     std::unique_ptr<Slicer> slicer_;
-    std::unique_ptr<ErasureCoder> erasure_coder_;
+    std::map<std::pair<int, int>, std::unique_ptr<ErasureCoder>> erasure_coders_;
+    std::unique_ptr<FecPacketizer> fec_packetizer_;
+    std::unique_ptr<FecController> fec_controller_;
     std::unique_ptr<Scheduler> scheduler_;
     std::vector<std::unique_ptr<PathMonitor>> path_monitors_;
+    std::unique_ptr<PacketPool> packet_pool_;  // outlives the sockets and collector below
     std::vector<std::unique_ptr<SenderReceiver>> sender_receivers_;
+    
+    // Congestion control, indexed like sender_receivers_: the controller
+    // estimates what the path carries, the reporter answers the far end
+    std::vector<std::unique_ptr<CongestionController>> congestion_controllers_;
+    std::vector<std::unique_ptr<FeedbackReporter>> feedback_reporters_;  // reactor thread
+    std::vector<uint8_t> feedback_buffer_;                               // reactor thread
+    std::vector<std::unique_ptr<Pacer>> pacers_;  // same indexing, used by the send thread
+    
+    // NACK: the send thread keeps what it sent, the reactor thread resends
+    // what the far end asks for and asks for what is missing here
+    std::unique_ptr<RetransmitCache> retransmit_cache_;
+    std::vector<std::vector<uint8_t>> retransmit_buffers_;  // reactor thread
+    std::vector<ConstByteSpan> retransmit_datagrams_;       // reactor thread
+    std::chrono::steady_clock::time_point last_nack_check_;  // reactor thread
+    uint32_t nack_sequence_;                                 // reactor thread
+    std::unique_ptr<NackHeader> nack_;                       // reactor thread
+    std::vector<uint8_t> nack_buffer_;                       // reactor thread
+    std::unique_ptr<NackHeader> received_nack_;              // reactor thread
+    size_t nack_path_;                                       // reactor thread
+    
+    // Keyframe requests: the network thread asks while its decoder waits
+    // for a keyframe, the reactor thread forces one on the encoder
+    std::chrono::steady_clock::time_point last_keyframe_request_;  // network thread
+    uint32_t keyframe_request_sequence_;                           // network thread
+    bool have_keyframe_request_;                                   // reactor thread
+    uint32_t last_keyframe_request_received_;                      // reactor thread
+    std::chrono::steady_clock::time_point last_forced_keyframe_;   // reactor thread
     std::unique_ptr<SmartCollector> collector_;
+    std::unique_ptr<Reactor> reactor_;
+    std::unique_ptr<UringReceiver> uring_receiver_;
+    
+    // Send pipeline: capture -> convert/encode -> packetize+FEC -> send,
+    // one thread per stage joined by bounded rings
+    struct CapturedFrame;
+    struct EncodedFrame;
+    struct SendBatch;
+    static constexpr size_t kCaptureQueueDepth = 2;  // raw frames, oldest dropped
+    static constexpr size_t kEncodedQueueDepth = 4;  // backpressure from here on
+    static constexpr size_t kSendQueueDepth = 8;   // data and parity batches
+    std::unique_ptr<PacketPool> send_pool_;  // parity copies; outlives send_queue_
+    std::unique_ptr<OverwriteRing<CapturedFrame>> capture_queue_;
+    std::unique_ptr<SpscRing<EncodedFrame>> encoded_queue_;
+    std::unique_ptr<SpscRing<SendBatch>> send_queue_;
+    std::vector<uint8_t> fec_layout_;  // packetize thread: padded image FEC protects
+    
+    // Send thread: path of each datagram, and each path's share of a batch
+    std::vector<size_t> stripe_;
+    std::vector<std::vector<ConstByteSpan>> path_queues_;
+    std::vector<size_t> path_progress_;
     
     // Threads
-    std::thread video_thread_;
+    std::thread capture_thread_;
+    std::thread encode_thread_;
+    std::thread packetize_thread_;
+    std::thread send_thread_;
     std::thread network_thread_;
     
+    // Receive side, owned by the network thread
+    bool have_receive_sequence_;
+    uint32_t next_receive_sequence_;
+    bool receive_frame_open_;  // Slices of the current frame still to come
+    std::vector<uint8_t> display_buffer_;
+    
     // Internal methods
     void initialize_components();
-    void video_processing_loop();
+    void create_reactor();
+    ErasureCoder& get_erasure_coder(int k, int r);
+    void capture_loop();
+    void encode_loop();
+    void packetize_loop();
+    void send_loop();
     void network_processing_loop();
-    void send_chunks(const std::vector<std::vector<uint8_t>>& data_chunks,
-                     const std::vector<std::vector<uint8_t>>& fec_chunks,
-                     uint32_t sequence_number);
-    void process_complete_frame(const std::vector<uint8_t>& frame_data);
+    void handle_datagram(ConstByteSpan datagram, size_t path_index);
+    void handle_packet(const PacketRef& packet, size_t path_index);
+    void handle_feedback(const FeedbackHeader& report, size_t path_index);
+    void handle_nack(const NackHeader& nack, size_t path_index);
+    void send_nacks(size_t path_index);
+    void request_keyframe();
+    void handle_keyframe_request(const KeyframeRequestHeader& request);
+    void update_target_bitrate(std::chrono::steady_clock::time_point now);
+    void send_chunks(const SendBatch& batch);
+    void record_sent(size_t path_index, const ConstByteSpan* datagrams, size_t count);
+    void process_complete_frame(ConstByteSpan frame_data, bool frame_start = true);
 };
\ No newline at end of file
@@ -30,7 +30,7 @@ private:
     std::string tune_;
 
 public:
-    VideoChat() : sock_(-1), running_(false), preset_("veryfast"), tune_("grain") {}
+    VideoChat() : sock_(-1), running_(false), preset_("veryfast"), tune_("zerolatency") {}
     
     ~VideoChat() {
         stop();
@@ -63,7 +63,7 @@ public:
             preset_ = preset_input;
         }
         
-        std::cout << "FFmpeg tune ayarı (film/animation/grain/fastdecode/zerolatency) [grain]: ";
+        std::cout << "FFmpeg tune ayarı (film/animation/grain/fastdecode/zerolatency) [zerolatency]: ";
         std::string tune_input;
         std::getline(std::cin, tune_input);
         if (!tune_input.empty()) {
@@ -1,61 +1,54 @@
 // erasure_coder.cpp
 #include "erasure_coder.h"
+#include "gf256.h"
 #include <stdexcept>
 #include <cstring>
 #include <algorithm>
 
-// Geçici implementasyon - Jerasure kütüphanesi olmadığı için
-ErasureCoder::ErasureCoder(const CodingParams& params) 
-    : params_(params), encoding_matrix_(nullptr), 
-      decoding_matrix_(nullptr), inverse_matrix_(nullptr) {
-    
+ErasureCoder::ErasureCoder(const CodingParams& params, size_t decode_cache_capacity)
+    : params_(params), cache_capacity_(decode_cache_capacity),
+      cache_hits_(0), cache_misses_(0) {
+
     if (params.k <= 0 || params.r <= 0 || params.w <= 0) {
         throw std::invalid_argument("Invalid coding parameters");
     }
-    
+
+    if (params.w != 8) {
+        throw std::invalid_argument("Only w=8 (GF(2^8)) is supported");
+    }
+
     if (params.k + params.r > 256) {
         throw std::invalid_argument("Total chunks cannot exceed 256");
     }
-    
-    // Basit Reed-Solomon matrix oluştur
+
     init_encoding_matrix();
-}
 
-ErasureCoder::~ErasureCoder() {
-    cleanup_matrices();
+    // Precompute every single data-chunk loss
+    single_loss_plans_.resize(params_.k);
+    for (int i = 0; i < params_.k; ++i) {
+        ErasureMask erased;
+        erased.set(i);
+        single_loss_plans_[i] = build_decode_plan(erased);
+    }
 }
 
+ErasureCoder::~ErasureCoder() = default;
+
 void ErasureCoder::init_encoding_matrix() {
-    // Basit Vandermonde matrix oluştur
-    encoding_matrix_ = new int[params_.k * params_.r];
-    
+    // Cauchy matrix: matrix[i][j] = 1 / (x_i + y_j) with x_i = k + i, y_j = j.
+    // All x_i and y_j are distinct, so every square submatrix of [I; C] is
+    // invertible and any r erasures can be recovered.
+    encoding_matrix_.resize(params_.r * params_.k);
+
     for (int i = 0; i < params_.r; ++i) {
         for (int j = 0; j < params_.k; ++j) {
-            // Basit Vandermonde matrix: matrix[i][j] = (i+1)^j
-            int value = 1;
-            for (int k = 0; k < j; ++k) {
-                value = (value * (i + 1)) % 256; // GF(2^8)
-            }
-            encoding_matrix_[i * params_.k + j] = value;
+            uint8_t x = static_cast<uint8_t>(params_.k + i);
+            uint8_t y = static_cast<uint8_t>(j);
+            encoding_matrix_[i * params_.k + j] = GF256::inv(GF256::add(x, y));
         }
     }
 }
 
-void ErasureCoder::cleanup_matrices() {
-    if (encoding_matrix_) {
-        delete[] encoding_matrix_;
-        encoding_matrix_ = nullptr;
-    }
-    if (decoding_matrix_) {
-        delete[] decoding_matrix_;
-        decoding_matrix_ = nullptr;
-    }
-    if (inverse_matrix_) {
-        delete[] inverse_matrix_;
-        inverse_matrix_ = nullptr;
-    }
-}
-
 size_t ErasureCoder::calculate_chunk_size(size_t data_size) const {
     size_t chunk_size = data_size / params_.k;
     if (data_size % params_.k != 0) {
@@ -64,73 +57,224 @@ size_t ErasureCoder::calculate_chunk_size(size_t data_size) const {
     return chunk_size;
 }
 
+size_t ErasureCoder::encode_parity(const ConstByteSpan* segments, size_t segment_count,
+                                   ParityArena& arena, size_t symbol_size, size_t headroom) {
+    size_t total_size = 0;
+    for (size_t i = 0; i < segment_count; ++i) {
+        total_size += segments[i].size;
+    }
+
+    if (symbol_size == 0) {
+        symbol_size = calculate_chunk_size(total_size);
+    }
+    if (total_size > symbol_size * params_.k) {
+        throw std::invalid_argument("Data does not fit into k symbols");
+    }
+
+    begin_parity(arena, symbol_size, headroom);
+    if (symbol_size == 0) {
+        return 0;
+    }
+
+    // Walk the gathered stream piece by piece; a piece never crosses a
+    // symbol boundary, so it is accumulated at its offset in every parity
+    // symbol and the short tail needs no padding.
+    size_t position = 0;
+    for (size_t s = 0; s < segment_count; ++s) {
+        const uint8_t* src = segments[s].data;
+        size_t remaining = segments[s].size;
+
+        while (remaining > 0) {
+            size_t column = position / symbol_size;
+            size_t offset = position % symbol_size;
+            size_t length = std::min(remaining, symbol_size - offset);
+
+            accumulate_parity(static_cast<int>(column), ConstByteSpan(src, length), arena, offset);
+
+            src += length;
+            remaining -= length;
+            position += length;
+        }
+    }
+
+    return symbol_size;
+}
+
+void ErasureCoder::begin_parity(ParityArena& arena, size_t symbol_size, size_t headroom) const {
+    arena.prepare(params_.r, symbol_size, headroom);
+    if (symbol_size == 0) {
+        return;
+    }
+    for (int i = 0; i < params_.r; ++i) {
+        std::memset(arena.symbol(i), 0, symbol_size);
+    }
+}
+
+void ErasureCoder::accumulate_parity(int column, ConstByteSpan data, ParityArena& arena,
+                                     size_t offset) const {
+    if (column < 0 || column >= params_.k || offset + data.size > arena.symbol_size()) {
+        throw std::invalid_argument("Parity column out of range");
+    }
+    for (int i = 0; i < params_.r; ++i) {
+        uint8_t coefficient = encoding_matrix_[i * params_.k + column];
+        GF256::mul_add_region(arena.symbol(i) + offset, data.data, coefficient, data.size);
+    }
+}
+
+size_t ErasureCoder::encode_parity(ConstByteSpan data, ParityArena& arena,
+                                   size_t symbol_size, size_t headroom) {
+    return encode_parity(&data, 1, arena, symbol_size, headroom);
+}
+
 std::vector<std::vector<uint8_t>> ErasureCoder::encode(const std::vector<uint8_t>& data) {
-    size_t chunk_size = calculate_chunk_size(data.size());
-    size_t padded_size = chunk_size * params_.k;
-    
-    // Pad data to fit exactly into k chunks
-    std::vector<uint8_t> padded_data = data;
-    padded_data.resize(padded_size, 0);
-    
-    // Create data chunks
+    ParityArena arena;
+    size_t chunk_size = encode_parity(ConstByteSpan(data), arena);
+
     std::vector<std::vector<uint8_t>> result;
     result.reserve(params_.k + params_.r);
-    
-    // Add data chunks
+
+    // Data chunks, last ones zero-padded
     for (int i = 0; i < params_.k; ++i) {
-        std::vector<uint8_t> chunk(padded_data.begin() + i * chunk_size, 
-                                   padded_data.begin() + (i + 1) * chunk_size);
+        std::vector<uint8_t> chunk(chunk_size, 0);
+        ConstByteSpan part = ConstByteSpan(data).subspan(i * chunk_size, chunk_size);
+        if (!part.empty()) {
+            std::memcpy(chunk.data(), part.data, part.size);
+        }
         result.push_back(std::move(chunk));
     }
-    
-    // Add parity chunks (basit XOR-based parity)
+
+    // Parity chunks
     for (int i = 0; i < params_.r; ++i) {
-        std::vector<uint8_t> parity_chunk(chunk_size, 0);
-        
-        // XOR-based parity calculation
-        for (int j = 0; j < params_.k; ++j) {
-            for (size_t k = 0; k < chunk_size; ++k) {
-                parity_chunk[k] ^= result[j][k];
-            }
-        }
-        
-        result.push_back(std::move(parity_chunk));
+        const uint8_t* parity = arena.symbol(i);
+        result.emplace_back(parity, parity + chunk_size);
     }
-    
+
     return result;
 }
 
 bool ErasureCoder::can_decode(const std::vector<int>& erasures) const {
     if (erasures.empty()) return true;
-    
+
     // Check if we have enough chunks
     int available_chunks = params_.k + params_.r - erasures.size();
     if (available_chunks < params_.k) return false;
-    
+
     // Check if erasures are valid
     for (int erasure : erasures) {
         if (erasure < 0 || erasure >= params_.k + params_.r) {
             return false;
         }
     }
-    
+
     return true;
 }
 
-void ErasureCoder::init_decoding_matrix(const std::vector<int>& erasures) {
-    if (erasures.empty()) return;
-    
-    // Basit decoding matrix oluştur
-    decoding_matrix_ = new int[params_.k * params_.k];
-    inverse_matrix_ = new int[params_.k * params_.k];
-    
-    // Identity matrix
-    for (int i = 0; i < params_.k; ++i) {
-        for (int j = 0; j < params_.k; ++j) {
-            decoding_matrix_[i * params_.k + j] = (i == j) ? 1 : 0;
-            inverse_matrix_[i * params_.k + j] = (i == j) ? 1 : 0;
+ErasureCoder::DecodePlanPtr ErasureCoder::build_decode_plan(const ErasureMask& erased) const {
+    int n = params_.k + params_.r;
+    auto plan = std::make_shared<DecodePlan>();
+
+    // Pick the first k surviving chunks; data rows are unit vectors
+    for (int i = 0; i < n && static_cast<int>(plan->rows.size()) < params_.k; ++i) {
+        if (!erased.test(i)) {
+            plan->rows.push_back(i);
+        }
+    }
+    if (static_cast<int>(plan->rows.size()) < params_.k) {
+        return nullptr;
+    }
+
+    plan->inverse.assign(params_.k * params_.k, 0);
+    for (int row = 0; row < params_.k; ++row) {
+        int index = plan->rows[row];
+        uint8_t* dst = &plan->inverse[row * params_.k];
+        if (index < params_.k) {
+            dst[index] = 1;
+        } else {
+            std::memcpy(dst, &encoding_matrix_[(index - params_.k) * params_.k], params_.k);
+        }
+    }
+
+    if (!GF256::invert_matrix(plan->inverse.data(), params_.k)) {
+        return nullptr;
+    }
+    return plan;
+}
+
+ErasureCoder::DecodePlanPtr ErasureCoder::get_decode_plan(const ErasureMask& erased) {
+    if (erased.count() == 1) {
+        for (int i = 0; i < params_.k; ++i) {
+            if (erased.test(i)) {
+                std::lock_guard<std::mutex> lock(cache_mutex_);
+                cache_hits_++;
+                return single_loss_plans_[i];
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = cache_index_.find(erased);
+        if (it != cache_index_.end()) {
+            // Move to front (most recently used)
+            lru_.splice(lru_.begin(), lru_, it->second);
+            cache_hits_++;
+            return it->second->second;
         }
+        cache_misses_++;
+    }
+
+    // Invert outside the lock
+    DecodePlanPtr plan = build_decode_plan(erased);
+    if (!plan || cache_capacity_ == 0) {
+        return plan;
     }
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (cache_index_.find(erased) == cache_index_.end()) {
+        lru_.emplace_front(erased, plan);
+        cache_index_[erased] = lru_.begin();
+        while (lru_.size() > cache_capacity_) {
+            cache_index_.erase(lru_.back().first);
+            lru_.pop_back();
+        }
+    }
+    return plan;
+}
+
+bool ErasureCoder::reconstruct(const std::vector<uint8_t*>& symbols,
+                               const std::vector<int>& erasures, size_t symbol_size) {
+    if (!can_decode(erasures) ||
+        symbols.size() != static_cast<size_t>(params_.k + params_.r)) {
+        return false;
+    }
+
+    ErasureMask erased;
+    bool data_lost = false;
+    for (int e : erasures) {
+        erased.set(e);
+        data_lost = data_lost || e < params_.k;
+    }
+    if (!data_lost) {
+        return true;
+    }
+
+    DecodePlanPtr plan = get_decode_plan(erased);
+    if (!plan) {
+        return false;
+    }
+
+    // data[e] = sum_j inverse[e][j] * survivor[j]
+    for (int e = 0; e < params_.k; ++e) {
+        if (!erased.test(e)) continue;
+        const uint8_t* row = &plan->inverse[e * params_.k];
+        uint8_t* out = symbols[e];
+        GF256::mul_region(out, symbols[plan->rows[0]], row[0], symbol_size);
+        for (int j = 1; j < params_.k; ++j) {
+            GF256::mul_add_region(out, symbols[plan->rows[j]], row[j], symbol_size);
+        }
+    }
+
+    return true;
 }
 
 std::vector<uint8_t> ErasureCoder::decode(const std::vector<std::vector<uint8_t>*>& chunks,
@@ -138,26 +282,73 @@ std::vector<uint8_t> ErasureCoder::decode(const std::vector<std::vector<uint8_t>
     if (!can_decode(erasures)) {
         throw std::runtime_error("Cannot decode with given erasures");
     }
-    
-    if (chunks.size() != params_.k + params_.r) {
+
+    if (chunks.size() != static_cast<size_t>(params_.k + params_.r)) {
         throw std::invalid_argument("Incorrect number of chunks");
     }
-    
-    size_t chunk_size = chunks[0]->size();
-    for (const auto& chunk : chunks) {
-        if (chunk->size() != chunk_size) {
+
+    std::vector<bool> erased(chunks.size(), false);
+    for (int e : erasures) {
+        erased[e] = true;
+    }
+
+    size_t chunk_size = 0;
+    bool size_known = false;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (erased[i]) continue;
+        if (!chunks[i]) {
+            throw std::invalid_argument("Missing chunk not listed in erasures");
+        }
+        if (!size_known) {
+            chunk_size = chunks[i]->size();
+            size_known = true;
+        } else if (chunks[i]->size() != chunk_size) {
             throw std::invalid_argument("All chunks must have the same size");
         }
     }
-    
-    // Basit XOR-based recovery
-    std::vector<uint8_t> result;
-    result.reserve(params_.k * chunk_size);
-    
-    // İlk k chunk'ı al
+
+    std::vector<uint8_t> result(params_.k * chunk_size);
+
+    // Surviving data chunks go straight to their slot, lost ones are rebuilt there
+    std::vector<uint8_t*> symbols(chunks.size());
     for (int i = 0; i < params_.k; ++i) {
-        result.insert(result.end(), chunks[i]->begin(), chunks[i]->end());
+        symbols[i] = result.data() + i * chunk_size;
+        if (!erased[i]) {
+            std::memcpy(symbols[i], chunks[i]->data(), chunk_size);
+        }
+    }
+    for (size_t i = params_.k; i < chunks.size(); ++i) {
+        symbols[i] = erased[i] ? nullptr : chunks[i]->data();
     }
-    
+
+    if (!reconstruct(symbols, erasures, chunk_size)) {
+        throw std::runtime_error("Decoding matrix is singular");
+    }
+
     return result;
-}
\ No newline at end of file
+}
+
+uint64_t ErasureCoder::get_cache_hits() const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return cache_hits_;
+}
+
+uint64_t ErasureCoder::get_cache_misses() const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return cache_misses_;
+}
+
+size_t ErasureCoder::get_cache_size() const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return lru_.size() + single_loss_plans_.size();
+}
+
+void ParityArena::prepare(int count, size_t symbol_size, size_t headroom) {
+    size_t required = static_cast<size_t>(count) * (headroom + symbol_size);
+    if (storage_.size() < required) {
+        storage_.resize(required);
+    }
+    symbol_count_ = count;
+    symbol_size_ = symbol_size;
+    headroom_ = headroom;
+}
@@ -3,49 +3,141 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <bitset>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include "../common/byte_span.h"
+
+// Caller-owned storage for parity symbols. It only grows, so reusing one
+// arena across frames keeps parity generation allocation-free. Each symbol
+// can be preceded by headroom bytes so a packet header is written in front
+// of it and the datagram goes out without another copy.
+class ParityArena {
+public:
+    ParityArena() : symbol_size_(0), symbol_count_(0), headroom_(0) {}
+
+    // Resize for count symbols of symbol_size bytes each
+    void prepare(int count, size_t symbol_size, size_t headroom = 0);
+
+    uint8_t* symbol(int index) { return storage_.data() + index * stride() + headroom_; }
+    const uint8_t* symbol(int index) const { return storage_.data() + index * stride() + headroom_; }
+    ConstByteSpan symbol_span(int index) const { return ConstByteSpan(symbol(index), symbol_size_); }
+
+    // Headroom + symbol, i.e. the full datagram once a header is written
+    uint8_t* packet(int index) { return storage_.data() + index * stride(); }
+    ConstByteSpan packet_span(int index) const {
+        return ConstByteSpan(storage_.data() + index * stride(), stride());
+    }
+
+    // Packet whose header_size byte header ends where the symbol begins
+    ConstByteSpan packet_span(int index, size_t header_size) const {
+        return ConstByteSpan(symbol(index) - header_size, header_size + symbol_size_);
+    }
+
+    size_t symbol_size() const { return symbol_size_; }
+    int symbol_count() const { return symbol_count_; }
+    size_t headroom() const { return headroom_; }
+
+private:
+    std::vector<uint8_t> storage_;
+    size_t symbol_size_;
+    int symbol_count_;
+    size_t headroom_;
+
+    size_t stride() const { return headroom_ + symbol_size_; }
+};
 
 class ErasureCoder {
 public:
     struct CodingParams {
         int k;  // Number of data chunks
         int r;  // Number of parity chunks
-        int w;  // Word size (8, 16, 32)
-        
-        CodingParams(int k_val, int r_val, int w_val = 8) 
+        int w;  // Word size (only 8 is supported)
+
+        CodingParams(int k_val, int r_val, int w_val = 8)
             : k(k_val), r(r_val), w(w_val) {}
     };
-    
-    ErasureCoder(const CodingParams& params);
+
+    // Erasure pattern over the k+r chunk positions
+    using ErasureMask = std::bitset<256>;
+
+    ErasureCoder(const CodingParams& params, size_t decode_cache_capacity = 64);
     ~ErasureCoder();
-    
+
     // Encode data into k data chunks and r parity chunks
     std::vector<std::vector<uint8_t>> encode(const std::vector<uint8_t>& data);
-    
-    // Decode data from available chunks (data + parity)
+
+    // Compute the r parity symbols for data gathered from segments without
+    // copying or padding it: data symbol j covers bytes [j*S, (j+1)*S) of the
+    // concatenated segments and anything past the end counts as zero.
+    // symbol_size 0 means ceil(total / k). Returns the symbol size used.
+    size_t encode_parity(const ConstByteSpan* segments, size_t segment_count,
+                         ParityArena& arena, size_t symbol_size = 0, size_t headroom = 0);
+    size_t encode_parity(ConstByteSpan data, ParityArena& arena,
+                         size_t symbol_size = 0, size_t headroom = 0);
+
+    // Incremental parity: begin_parity() zeroes r symbols, then each data
+    // symbol is folded in as column j (0..k-1) whenever it becomes available.
+    // Shorter data counts as zero padded. Used by interleaved FEC, where a
+    // block collects its symbols across several frames.
+    void begin_parity(ParityArena& arena, size_t symbol_size, size_t headroom = 0) const;
+    void accumulate_parity(int column, ConstByteSpan data, ParityArena& arena,
+                           size_t offset = 0) const;
+
+    // Decode data from available chunks (data + parity).
+    // Erased entries may be nullptr.
     std::vector<uint8_t> decode(const std::vector<std::vector<uint8_t>*>& chunks,
                                 const std::vector<int>& erasures);
-    
+
+    // Rebuild erased data symbols in place. symbols holds k+r pointers of
+    // symbol_size bytes each; erased data entries must point to writable
+    // storage. Parity symbols are not regenerated.
+    bool reconstruct(const std::vector<uint8_t*>& symbols,
+                     const std::vector<int>& erasures, size_t symbol_size);
+
     // Get coding parameters
     const CodingParams& get_params() const { return params_; }
-    
+
     // Calculate chunk size for given data size
     size_t calculate_chunk_size(size_t data_size) const;
-    
+
     // Check if decoding is possible with given erasures
     bool can_decode(const std::vector<int>& erasures) const;
 
+    // Decode matrix cache statistics
+    uint64_t get_cache_hits() const;
+    uint64_t get_cache_misses() const;
+    size_t get_cache_size() const;
+
 private:
+    // Inverted decoding matrix for one erasure pattern
+    struct DecodePlan {
+        std::vector<int> rows;         // chunk index of each surviving row used
+        std::vector<uint8_t> inverse;  // k x k inverse of those rows
+    };
+    using DecodePlanPtr = std::shared_ptr<const DecodePlan>;
+    using LruList = std::list<std::pair<ErasureMask, DecodePlanPtr>>;
+
     CodingParams params_;
-    int* encoding_matrix_;
-    int* decoding_matrix_;
-    int* inverse_matrix_;
-    
+    std::vector<uint8_t> encoding_matrix_;  // r x k Cauchy rows
+
+    // Single data-chunk losses are precomputed and never evicted; other
+    // patterns live in an LRU cache so inversion stays off the hot path
+    std::vector<DecodePlanPtr> single_loss_plans_;
+    size_t cache_capacity_;
+    mutable std::mutex cache_mutex_;
+    LruList lru_;
+    std::unordered_map<ErasureMask, LruList::iterator> cache_index_;
+    uint64_t cache_hits_;
+    uint64_t cache_misses_;
+
     // Initialize encoding matrix
     void init_encoding_matrix();
-    
-    // Initialize decoding matrix for given erasures
-    void init_decoding_matrix(const std::vector<int>& erasures);
-    
-    // Free matrices
-    void cleanup_matrices();
-};
\ No newline at end of file
+
+    // Build the inverted decoding matrix for an erasure pattern
+    DecodePlanPtr build_decode_plan(const ErasureMask& erased) const;
+
+    // Look up (or build and cache) the plan for an erasure pattern
+    DecodePlanPtr get_decode_plan(const ErasureMask& erased);
+};
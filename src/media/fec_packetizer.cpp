@@ -0,0 +1,194 @@
+// fec_packetizer.cpp
+#include "fec_packetizer.h"
+#include <stdexcept>
+#include <limits>
+#include <utility>
+
+FecPacketizer::FecPacketizer(size_t symbol_size)
+    : symbol_size_(symbol_size), block_count_(0), interleave_depth_(1),
+      next_lane_(0), next_block_id_(0) {
+    if (symbol_size == 0 || symbol_size > std::numeric_limits<uint16_t>::max()) {
+        throw std::invalid_argument("Invalid FEC symbol size");
+    }
+}
+
+void FecPacketizer::set_interleave_depth(int depth) {
+    if (depth < 1 || depth > std::numeric_limits<uint8_t>::max()) {
+        throw std::invalid_argument("Invalid FEC interleave depth");
+    }
+    interleave_depth_ = depth;
+}
+
+int FecPacketizer::get_interleave_depth() const {
+    return interleave_depth_;
+}
+
+size_t FecPacketizer::protect_frame(ErasureCoder& coder, ConstByteSpan frame,
+                                    uint32_t sequence_number) {
+    block_count_ = 0;
+
+    if (interleave_depth_ <= 1) {
+        // Switching back from interleaving: send what the lanes hold
+        flush_all_lanes();
+        protect_frame_blocks(coder, frame, sequence_number);
+    } else {
+        protect_frame_interleaved(coder, frame, sequence_number);
+    }
+
+    return get_packet_count();
+}
+
+FecPacketizer::OutputBlock& FecPacketizer::next_output_block() {
+    if (blocks_.size() <= block_count_) {
+        blocks_.resize(block_count_ + 1);
+    }
+    return blocks_[block_count_++];
+}
+
+void FecPacketizer::protect_frame_blocks(ErasureCoder& coder, ConstByteSpan frame,
+                                         uint32_t sequence_number) {
+    const auto& params = coder.get_params();
+    size_t total_chunks = (frame.size + symbol_size_ - 1) / symbol_size_;
+    size_t block_bytes = symbol_size_ * params.k;
+    size_t frame_blocks = (frame.size + block_bytes - 1) / block_bytes;
+
+    FecHeader header;
+    header.sequence_number = sequence_number;
+    header.total_chunks = static_cast<uint16_t>(total_chunks);
+    header.symbol_size = static_cast<uint16_t>(symbol_size_);
+    header.frame_length = static_cast<uint32_t>(frame.size);
+    header.k = static_cast<uint8_t>(params.k);
+    header.r = static_cast<uint8_t>(params.r);
+
+    for (size_t b = 0; b < frame_blocks; ++b) {
+        // The last block may hold fewer than k chunks; missing ones count as zero
+        ConstByteSpan block = frame.subspan(b * block_bytes, block_bytes);
+        OutputBlock& output = next_output_block();
+        output.header_size = FecHeader::kSize;
+        coder.encode_parity(block, output.arena, symbol_size_, FecHeader::kSize);
+
+        header.block_id = static_cast<uint16_t>(b);
+        for (int i = 0; i < params.r; ++i) {
+            header.index = static_cast<uint8_t>(params.k + i);
+            header.write(output.arena.packet(i));
+        }
+    }
+}
+
+void FecPacketizer::protect_frame_interleaved(ErasureCoder& coder, ConstByteSpan frame,
+                                              uint32_t sequence_number) {
+    const auto& params = coder.get_params();
+
+    // Lanes are bound to the coder they were started with
+    if (lanes_.size() != static_cast<size_t>(interleave_depth_)) {
+        flush_all_lanes();
+        lanes_.resize(interleave_depth_);
+        next_lane_ = 0;
+    }
+    for (auto& lane : lanes_) {
+        if (lane.open && (lane.header.k != params.k || lane.header.r != params.r)) {
+            flush_lane(lane);
+        }
+    }
+
+    size_t total_chunks = (frame.size + symbol_size_ - 1) / symbol_size_;
+    InterleavedFecHeader::FrameEntry entry;
+    entry.sequence_number = sequence_number;
+    entry.total_chunks = static_cast<uint16_t>(total_chunks);
+    entry.frame_length = static_cast<uint32_t>(frame.size);
+
+    for (size_t chunk_id = 0; chunk_id < total_chunks; ++chunk_id) {
+        Lane& lane = lanes_[next_lane_];
+        next_lane_ = (next_lane_ + 1) % lanes_.size();
+
+        InterleavedFecHeader& header = lane.header;
+        if (!lane.open) {
+            coder.begin_parity(lane.arena, symbol_size_, InterleavedFecHeader::max_size(params.k));
+            header.base_sequence = sequence_number;
+            header.block_id = next_block_id_++;
+            header.symbol_size = static_cast<uint16_t>(symbol_size_);
+            header.k = static_cast<uint8_t>(params.k);
+            header.r = static_cast<uint8_t>(params.r);
+            header.frames.clear();
+            header.members.clear();
+            lane.open = true;
+        }
+
+        if (header.frames.empty() || header.frames.back().sequence_number != sequence_number) {
+            header.frames.push_back(entry);
+        }
+
+        InterleavedFecHeader::Member member;
+        member.frame_index = static_cast<uint8_t>(header.frames.size() - 1);
+        member.chunk_id = static_cast<uint16_t>(chunk_id);
+        int column = static_cast<int>(header.members.size());
+        header.members.push_back(member);
+
+        coder.accumulate_parity(column, frame.subspan(chunk_id * symbol_size_, symbol_size_), lane.arena);
+
+        if (static_cast<int>(header.members.size()) == params.k) {
+            flush_lane(lane);
+        }
+    }
+
+    // Close blocks that would otherwise span more than depth frames
+    for (auto& lane : lanes_) {
+        if (lane.open &&
+            sequence_number - lane.header.base_sequence >= static_cast<uint32_t>(interleave_depth_ - 1)) {
+            flush_lane(lane);
+        }
+    }
+}
+
+void FecPacketizer::flush_lane(Lane& lane) {
+    if (!lane.open) {
+        return;
+    }
+    lane.open = false;
+
+    OutputBlock& output = next_output_block();
+    std::swap(output.arena, lane.arena);
+
+    InterleavedFecHeader& header = lane.header;
+    output.header_size = header.size();
+    for (int i = 0; i < header.r; ++i) {
+        header.index = static_cast<uint8_t>(header.k + i);
+        header.write(output.arena.symbol(i) - output.header_size);
+    }
+}
+
+void FecPacketizer::flush_all_lanes() {
+    for (auto& lane : lanes_) {
+        flush_lane(lane);
+    }
+}
+
+size_t FecPacketizer::get_packet_count() const {
+    size_t count = 0;
+    for (size_t i = 0; i < block_count_; ++i) {
+        count += blocks_[i].arena.symbol_count();
+    }
+    return count;
+}
+
+ConstByteSpan FecPacketizer::get_packet(size_t index) const {
+    // Parity index major order: a loss burst on the wire then takes one
+    // parity symbol from several blocks instead of all of one block's
+    for (int level = 0; index < get_packet_count(); ++level) {
+        for (size_t i = 0; i < block_count_; ++i) {
+            const OutputBlock& block = blocks_[i];
+            if (level >= block.arena.symbol_count()) {
+                continue;
+            }
+            if (index == 0) {
+                return block.arena.packet_span(level, block.header_size);
+            }
+            index--;
+        }
+    }
+    return ConstByteSpan();
+}
+
+size_t FecPacketizer::get_symbol_size() const {
+    return symbol_size_;
+}
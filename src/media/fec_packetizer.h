@@ -0,0 +1,65 @@
+// fec_packetizer.h
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "erasure_coder.h"
+#include "../transport/packet_header.h"
+#include "../common/byte_span.h"
+
+// Builds framed parity packets for the Slicer chunks of each frame. The
+// symbol size is the Slicer max chunk size, so every data symbol is exactly
+// one chunk and the receiver can rebuild lost chunks one to one.
+//
+// Per-frame mode (depth 1): block b protects chunks [b*k, b*k + k) of the
+// frame and its parity is sent with the frame (FecHeader).
+//
+// Interleaved mode (depth > 1): consecutive chunks are dealt round-robin to
+// depth lanes, and each lane collects k chunks into a block that may span
+// up to depth consecutive frames (InterleavedFecHeader). A loss burst then
+// costs each block only about burst/depth symbols, at the same overhead,
+// for up to depth-1 frames of extra recovery delay.
+class FecPacketizer {
+public:
+    explicit FecPacketizer(size_t symbol_size);
+
+    // Number of frames a block may span; 1 disables interleaving
+    void set_interleave_depth(int depth);
+    int get_interleave_depth() const;
+
+    // Build parity packets for one encoded frame; returns the packet count
+    size_t protect_frame(ErasureCoder& coder, ConstByteSpan frame, uint32_t sequence_number);
+
+    // Packets produced by the last protect_frame call, valid until the next one
+    size_t get_packet_count() const;
+    ConstByteSpan get_packet(size_t index) const;
+
+    size_t get_symbol_size() const;
+
+private:
+    struct OutputBlock {
+        ParityArena arena;
+        size_t header_size;
+    };
+
+    struct Lane {
+        ParityArena arena;
+        InterleavedFecHeader header;
+        bool open;
+
+        Lane() : open(false) {}
+    };
+
+    size_t symbol_size_;
+    std::vector<OutputBlock> blocks_;
+    size_t block_count_;
+    int interleave_depth_;
+    std::vector<Lane> lanes_;
+    size_t next_lane_;
+    uint16_t next_block_id_;
+
+    OutputBlock& next_output_block();
+    void protect_frame_blocks(ErasureCoder& coder, ConstByteSpan frame, uint32_t sequence_number);
+    void protect_frame_interleaved(ErasureCoder& coder, ConstByteSpan frame, uint32_t sequence_number);
+    void flush_lane(Lane& lane);
+    void flush_all_lanes();
+};
@@ -0,0 +1,240 @@
+// ffmpeg_decoder.cpp
+#include "ffmpeg_decoder.h"
+
+#ifdef FFMPEG_AVAILABLE
+#include "../common/logger.h"
+extern "C" {
+#include <libavutil/pixfmt.h>
+}
+#include <vector>
+#include <string>
+#include <cerrno>
+
+namespace {
+
+// Visit every NAL unit in an Annex B stream; the visitor gets a pointer to
+// the NAL header and the bytes left in the buffer from there
+template <typename Visitor>
+bool any_nal(const uint8_t* data, size_t size, Visitor visit) {
+    for (size_t i = 0; i + 3 < size; ++i) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            if (visit(data + i + 3, size - i - 3)) {
+                return true;
+            }
+            i += 2;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+FFmpegDecoder::FFmpegDecoder(const DecoderConfig& config)
+    : config_(config), codec_(nullptr), codec_context_(nullptr), packet_(nullptr),
+      frames_{nullptr, nullptr}, next_frame_(0), sws_context_(nullptr),
+      waiting_for_keyframe_(true), decoded_frames_(0), skipped_frames_(0) {
+}
+
+FFmpegDecoder::~FFmpegDecoder() {
+    cleanup();
+}
+
+bool FFmpegDecoder::initialize() {
+    try {
+        // Find decoder
+        codec_ = avcodec_find_decoder_by_name(config_.codec_name.c_str());
+        if (!codec_) {
+            return false; // Decoder not found, but don't crash
+        }
+
+        // Allocate context
+        codec_context_ = avcodec_alloc_context3(codec_);
+        if (!codec_context_) {
+            return false;
+        }
+
+        // Slice threading decodes each frame on several cores without
+        // delay; frame threading scales further but holds frames back
+        codec_context_->thread_count = config_.thread_count;
+        if (config_.frame_threading) {
+            codec_context_->thread_type = FF_THREAD_FRAME;
+        } else {
+            codec_context_->thread_type = FF_THREAD_SLICE;
+            codec_context_->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        }
+        
+        // Slices are decoded as they arrive instead of once the frame is whole
+        if (config_.chunked_input) {
+            codec_context_->flags2 |= AV_CODEC_FLAG2_CHUNKS;
+        }
+
+        // Open codec
+        if (avcodec_open2(codec_context_, codec_, nullptr) < 0) {
+            cleanup();
+            return false;
+        }
+
+        // Allocate reusable output frames and packet
+        for (int i = 0; i < kOutputFrames; ++i) {
+            frames_[i] = av_frame_alloc();
+            if (!frames_[i]) {
+                cleanup();
+                return false;
+            }
+        }
+
+        packet_ = av_packet_alloc();
+        if (!packet_) {
+            cleanup();
+            return false;
+        }
+
+        return true;
+
+    } catch (...) {
+        cleanup();
+        return false;
+    }
+}
+
+const AVFrame* FFmpegDecoder::decode_frame(const uint8_t* data, size_t size, bool frame_start) {
+    if (!codec_context_ || !packet_ || !data || size == 0) {
+        return nullptr;
+    }
+
+    try {
+        // Decoding from a lost reference only spreads corruption; wait for
+        // the next IDR or recovery point and start over from a clean state.
+        // The rest of a skipped frame is skipped with it.
+        if (waiting_for_keyframe_) {
+            if (!frame_start) {
+                return nullptr;
+            }
+            if (!is_keyframe(data, size, codec_->id)) {
+                skipped_frames_++;
+                return nullptr;
+            }
+            avcodec_flush_buffers(codec_context_);
+            waiting_for_keyframe_ = false;
+        }
+
+        // The packet is not refcounted, so libavcodec takes a padded copy
+        packet_->data = const_cast<uint8_t*>(data);
+        packet_->size = static_cast<int>(size);
+        int ret = avcodec_send_packet(codec_context_, packet_);
+        packet_->data = nullptr;
+        packet_->size = 0;
+        if (ret < 0 && ret != AVERROR(EAGAIN)) {
+            LOG_WARNING("Decoder paketi reddetti, keyframe bekleniyor");
+            notify_loss();
+            return nullptr;
+        }
+
+        // Receive into the older of the output frames; the previous picture
+        // stays untouched for whoever is still showing it
+        AVFrame* frame = frames_[next_frame_];
+        av_frame_unref(frame);
+        ret = avcodec_receive_frame(codec_context_, frame);
+        if (ret < 0) {
+            return nullptr;
+        }
+
+        // Pictures of an intra refresh sweep still in progress; the decoder
+        // clears the flag itself once the sweep has covered the frame
+        if (frame->flags & AV_FRAME_FLAG_CORRUPT) {
+            skipped_frames_++;
+            return nullptr;
+        }
+
+        next_frame_ = (next_frame_ + 1) % kOutputFrames;
+        decoded_frames_++;
+        return frame;
+
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void FFmpegDecoder::notify_loss() {
+    waiting_for_keyframe_ = true;
+}
+
+bool FFmpegDecoder::is_keyframe(const uint8_t* data, size_t size, AVCodecID codec_id) {
+    if (codec_id == AV_CODEC_ID_H264) {
+        return any_nal(data, size, [](const uint8_t* nal, size_t remaining) {
+            int type = nal[0] & 0x1F;
+            if (type == 5 || type == 7) {
+                return true;  // IDR slice, or the SPS sent only ahead of one
+            }
+            // SEI whose first message is a recovery point: the start of an
+            // intra refresh sweep (x264 writes it in a NAL of its own)
+            return type == 6 && remaining > 1 && nal[1] == 6;
+        });
+    }
+    if (codec_id == AV_CODEC_ID_HEVC) {
+        return any_nal(data, size, [](const uint8_t* nal, size_t) {
+            int type = (nal[0] >> 1) & 0x3F;
+            return type >= 16 && type <= 21;  // IRAP
+        });
+    }
+
+    // Unknown bitstream; let the decoder judge
+    return true;
+}
+
+bool FFmpegDecoder::convert_frame(const AVFrame* frame, std::vector<uint8_t>& output,
+                                  int& width, int& height) {
+    if (!frame || frame->width <= 0 || frame->height <= 0) {
+        return false;
+    }
+
+    width = frame->width;
+    height = frame->height;
+
+    sws_context_ = sws_getCachedContext(
+        sws_context_,
+        width, height, static_cast<AVPixelFormat>(frame->format),
+        width, height, AV_PIX_FMT_BGR24,
+        SWS_BILINEAR, nullptr, nullptr, nullptr
+    );
+    if (!sws_context_) {
+        return false;
+    }
+
+    output.resize(static_cast<size_t>(width) * height * 3);
+    uint8_t* dst_data[4] = {output.data(), nullptr, nullptr, nullptr};
+    int dst_linesize[4] = {width * 3, 0, 0, 0};
+
+    // Scale and convert
+    if (sws_scale(sws_context_, frame->data, frame->linesize, 0, height,
+                  dst_data, dst_linesize) < 0) {
+        return false;
+    }
+
+    return true;
+}
+
+void FFmpegDecoder::cleanup() {
+    if (sws_context_) {
+        sws_freeContext(sws_context_);
+        sws_context_ = nullptr;
+    }
+
+    if (packet_) {
+        av_packet_free(&packet_);
+    }
+
+    for (int i = 0; i < kOutputFrames; ++i) {
+        if (frames_[i]) {
+            av_frame_free(&frames_[i]);
+        }
+    }
+
+    if (codec_context_) {
+        avcodec_free_context(&codec_context_);
+    }
+
+    codec_ = nullptr;
+}
+
+#endif
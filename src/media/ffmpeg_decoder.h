@@ -0,0 +1,123 @@
+// ffmpeg_decoder.h
+#pragma once
+
+// FFmpeg kütüphaneleri varsa include et
+#ifdef FFMPEG_AVAILABLE
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Receive-side counterpart of FFmpegEncoder. Decodes one access unit per
+// call into a small set of reusable AVFrames and hands the frame out by
+// pointer, so decoded pictures are never copied. After a loss the decoder
+// drops input until the next IDR or intra refresh recovery point instead of
+// decoding from broken references.
+class FFmpegDecoder {
+public:
+    struct DecoderConfig {
+        std::string codec_name;
+        int thread_count;       // 0 = one per core
+        bool frame_threading;   // Higher throughput, adds thread_count-1 frames of delay
+        bool chunked_input;     // Input may be any run of whole NAL units of a frame
+
+        DecoderConfig(const std::string& c = "h264", int t = 0, bool f = false, bool ch = false)
+            : codec_name(c), thread_count(t), frame_threading(f), chunked_input(ch) {}
+    };
+
+    FFmpegDecoder(const DecoderConfig& config);
+    ~FFmpegDecoder();
+
+    // Initialize decoder
+    bool initialize();
+
+    // Decode one access unit. Returns the next picture, or nullptr if none is
+    // ready yet (frame threading delay) or the unit was skipped. The frame
+    // stays valid until the decode call after next.
+    // With chunked_input, data may also be part of an access unit cut at a
+    // NAL boundary; frame_start marks its first part, and the picture comes
+    // out of the call that completes it.
+    const AVFrame* decode_frame(const uint8_t* data, size_t size, bool frame_start = true);
+
+    // Report frames lost before this point; input is dropped until an IDR or
+    // recovery point
+    void notify_loss();
+
+    // Convert a decoded picture to packed BGR24 for display; output is
+    // resized as needed and can be reused across calls
+    bool convert_frame(const AVFrame* frame, std::vector<uint8_t>& output, int& width, int& height);
+
+    // Get decoder configuration
+    const DecoderConfig& get_config() const { return config_; }
+
+    // Check if decoder is initialized
+    bool is_initialized() const { return codec_context_ != nullptr; }
+
+    // Whether input is being dropped until the next keyframe
+    bool is_waiting_for_keyframe() const { return waiting_for_keyframe_; }
+
+    // Get statistics
+    uint64_t get_decoded_count() const { return decoded_frames_; }
+    uint64_t get_skipped_count() const { return skipped_frames_; }
+
+    // True if decoding can (re)start at this access unit
+    static bool is_keyframe(const uint8_t* data, size_t size, AVCodecID codec_id);
+
+private:
+    static constexpr int kOutputFrames = 2;
+
+    DecoderConfig config_;
+    const AVCodec* codec_;
+    AVCodecContext* codec_context_;
+    AVPacket* packet_;
+    AVFrame* frames_[kOutputFrames];
+    int next_frame_;
+    SwsContext* sws_context_;
+    bool waiting_for_keyframe_;
+    uint64_t decoded_frames_;
+    uint64_t skipped_frames_;
+
+    // Cleanup resources
+    void cleanup();
+};
+#else
+// FFmpeg yoksa dummy class
+#include <vector>
+#include <string>
+#include <cstdint>
+
+struct AVFrame;
+
+class FFmpegDecoder {
+public:
+    struct DecoderConfig {
+        std::string codec_name;
+        int thread_count;
+        bool frame_threading;
+        bool chunked_input;
+
+        DecoderConfig(const std::string& c = "h264", int t = 0, bool f = false, bool ch = false)
+            : codec_name(c), thread_count(t), frame_threading(f), chunked_input(ch) {}
+    };
+
+    FFmpegDecoder(const DecoderConfig& config) : config_(config) {}
+    ~FFmpegDecoder() {}
+
+    bool initialize() { return false; }
+    const AVFrame* decode_frame(const uint8_t*, size_t, bool = true) { return nullptr; }
+    void notify_loss() {}
+    bool convert_frame(const AVFrame*, std::vector<uint8_t>&, int&, int&) { return false; }
+    const DecoderConfig& get_config() const { return config_; }
+    bool is_initialized() const { return false; }
+    bool is_waiting_for_keyframe() const { return false; }
+    uint64_t get_decoded_count() const { return 0; }
+    uint64_t get_skipped_count() const { return 0; }
+
+private:
+    DecoderConfig config_;
+};
+#endif
@@ -2,18 +2,65 @@
 #include "ffmpeg_encoder.h"
 
 #ifdef FFMPEG_AVAILABLE
+extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
 #include <libswscale/swscale.h>
+}
 #include <vector>
 #include <memory>
 #include <string>
 #include <stdexcept>
+#include <algorithm>
+
+namespace {
+
+AVPixelFormat to_av_format(FFmpegEncoder::PixelFormat format) {
+    switch (format) {
+        case FFmpegEncoder::PixelFormat::BGR24: return AV_PIX_FMT_BGR24;
+        case FFmpegEncoder::PixelFormat::RGB24: return AV_PIX_FMT_RGB24;
+        case FFmpegEncoder::PixelFormat::NV12: return AV_PIX_FMT_NV12;
+        case FFmpegEncoder::PixelFormat::YUYV: return AV_PIX_FMT_YUYV422;
+        case FFmpegEncoder::PixelFormat::YUV420P: return AV_PIX_FMT_YUV420P;
+    }
+    return AV_PIX_FMT_NONE;
+}
+
+// Plane pointers for a frame laid out as in OpenCV/V4L2 buffers
+bool fill_planes(const uint8_t* input, int width, int height, AVPixelFormat format,
+                 int stride, uint8_t* data[4], int linesize[4]) {
+    if (av_image_fill_arrays(data, linesize, input, format, width, height, 1) < 0) {
+        return false;
+    }
+    if (stride <= 0 || stride == linesize[0]) {
+        return true;
+    }
+    
+    // Padded rows: chroma planes start after the padded luma plane
+    uint8_t* base = const_cast<uint8_t*>(input);
+    if (format == AV_PIX_FMT_NV12) {
+        data[1] = base + static_cast<size_t>(stride) * height;
+        linesize[0] = linesize[1] = stride;
+    } else if (format == AV_PIX_FMT_YUV420P) {
+        int chroma_stride = stride / 2;
+        data[1] = base + static_cast<size_t>(stride) * height;
+        data[2] = data[1] + static_cast<size_t>(chroma_stride) * ((height + 1) / 2);
+        linesize[0] = stride;
+        linesize[1] = linesize[2] = chroma_stride;
+    } else {
+        linesize[0] = stride;
+    }
+    return true;
+}
+
+} // namespace
 
 FFmpegEncoder::FFmpegEncoder(const EncoderConfig& config) 
     : config_(config), codec_(nullptr), codec_context_(nullptr), 
-      frame_(nullptr), packet_(nullptr), sws_context_(nullptr) {
+      frame_(nullptr), packet_(nullptr), sws_context_(nullptr), last_keyframe_(false),
+      next_pts_(0), current_bitrate_(config.bitrate), pending_bitrate_(0),
+      keyframe_requested_(false) {
 }
 
 FFmpegEncoder::~FFmpegEncoder() {
@@ -40,14 +87,33 @@ bool FFmpegEncoder::initialize() {
         codec_context_->time_base = {1, config_.fps};
         codec_context_->framerate = {config_.fps, 1};
         codec_context_->pix_fmt = AV_PIX_FMT_YUV420P;
-        codec_context_->bit_rate = config_.bitrate;
-        codec_context_->gop_size = 10;
         codec_context_->max_b_frames = 0;
         
-        // Set codec-specific options (preset and tune)
+        // With intra refresh this is the length of one refresh sweep, i.e.
+        // how long a lost reference can stay visible; otherwise the IDR period
+        codec_context_->gop_size = config_.gop_size > 0 ? config_.gop_size : config_.fps;
+        
+        // CBR under a VBV of about one frame, so no frame, keyframe or not,
+        // takes much longer than a frame interval to drain onto the link
+        apply_bitrate(config_.bitrate);
+        
+        // Set codec-specific options. zerolatency drops lookahead and B-frames,
+        // so every input frame comes out of the matching encode_frame call.
         if (codec_->id == AV_CODEC_ID_H264) {
-            av_opt_set(codec_context_->priv_data, "preset", config_.preset.c_str(), 0);
-            av_opt_set(codec_context_->priv_data, "tune", config_.tune.c_str(), 0);
+            void* priv = codec_context_->priv_data;
+            av_opt_set(priv, "preset", config_.preset.c_str(), 0);
+            av_opt_set(priv, "tune", config_.tune.c_str(), 0);
+            
+            // Spread intra coding over the GOP instead of one large IDR;
+            // force_keyframe() still has to produce a real IDR
+            av_opt_set_int(priv, "intra-refresh", config_.intra_refresh ? 1 : 0, 0);
+            av_opt_set_int(priv, "forced-idr", 1, 0);
+            
+            // Bounded slices are self-contained NAL units the packetizer
+            // can ship as they are
+            if (config_.slice_max_size > 0) {
+                av_opt_set_int(priv, "slice-max-size", config_.slice_max_size, 0);
+            }
         }
         
         // Open codec
@@ -91,21 +157,40 @@ bool FFmpegEncoder::init_frame() {
     return true;
 }
 
-bool FFmpegEncoder::convert_frame(const uint8_t* input_data, int width, int height) {
-    if (!sws_context_) {
-        sws_context_ = sws_getContext(
-            width, height, AV_PIX_FMT_RGB24,
-            config_.width, config_.height, AV_PIX_FMT_YUV420P,
-            SWS_BILINEAR, nullptr, nullptr, nullptr
-        );
-        if (!sws_context_) {
-            return false;
-        }
-    }
+bool FFmpegEncoder::convert_frame(const uint8_t* input_data, int width, int height,
+                                  PixelFormat format, int stride) {
+    AVPixelFormat input_format = to_av_format(format);
     
     // Set up source data
-    uint8_t* src_data[4] = {const_cast<uint8_t*>(input_data), nullptr, nullptr, nullptr};
-    int src_linesize[4] = {width * 3, 0, 0, 0};
+    uint8_t* src_data[4] = {nullptr, nullptr, nullptr, nullptr};
+    int src_linesize[4] = {0, 0, 0, 0};
+    if (!fill_planes(input_data, width, height, input_format, stride, src_data, src_linesize)) {
+        return false;
+    }
+    
+    // The encoder may still reference the previous frame's buffers
+    if (av_frame_make_writable(frame_) < 0) {
+        return false;
+    }
+    
+    // Native layout at the target size needs a plain copy, not a scaler pass
+    if (input_format == AV_PIX_FMT_YUV420P && width == config_.width && height == config_.height) {
+        av_image_copy(frame_->data, frame_->linesize,
+                      const_cast<const uint8_t**>(src_data), src_linesize,
+                      AV_PIX_FMT_YUV420P, width, height);
+        return true;
+    }
+    
+    // Rebuilt only if the format or size changed since the last frame
+    sws_context_ = sws_getCachedContext(
+        sws_context_,
+        width, height, input_format,
+        config_.width, config_.height, AV_PIX_FMT_YUV420P,
+        SWS_BILINEAR, nullptr, nullptr, nullptr
+    );
+    if (!sws_context_) {
+        return false;
+    }
     
     // Scale and convert
     if (sws_scale(sws_context_, src_data, src_linesize, 0, height,
@@ -116,17 +201,28 @@ bool FFmpegEncoder::convert_frame(const uint8_t* input_data, int width, int heig
     return true;
 }
 
-std::vector<uint8_t> FFmpegEncoder::encode_frame(const uint8_t* frame_data, int width, int height) {
+std::vector<uint8_t> FFmpegEncoder::encode_frame(const uint8_t* frame_data, int width, int height,
+                                                PixelFormat format, int stride) {
     if (!codec_context_ || !frame_ || !packet_) {
         return {};
     }
     
     try {
         // Convert frame
-        if (!convert_frame(frame_data, width, height)) {
+        if (!convert_frame(frame_data, width, height, format, stride)) {
             return {};
         }
         
+        // Requests queued from other threads take effect on this frame;
+        // the rate change is picked up without reopening the codec
+        int bitrate = pending_bitrate_.exchange(0, std::memory_order_relaxed);
+        if (bitrate > 0) {
+            apply_bitrate(bitrate);
+        }
+        bool keyframe = keyframe_requested_.exchange(false, std::memory_order_relaxed);
+        frame_->pict_type = keyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+        frame_->pts = next_pts_++;
+        
         // Send frame to encoder
         if (avcodec_send_frame(codec_context_, frame_) < 0) {
             return {};
@@ -139,6 +235,7 @@ std::vector<uint8_t> FFmpegEncoder::encode_frame(const uint8_t* frame_data, int
         
         // Copy packet data
         std::vector<uint8_t> encoded_data(packet_->data, packet_->data + packet_->size);
+        last_keyframe_ = (packet_->flags & AV_PKT_FLAG_KEY) != 0;
         
         // Unref packet
         av_packet_unref(packet_);
@@ -150,6 +247,22 @@ std::vector<uint8_t> FFmpegEncoder::encode_frame(const uint8_t* frame_data, int
     }
 }
 
+void FFmpegEncoder::set_bitrate(int bitrate) {
+    if (bitrate > 0) {
+        pending_bitrate_.store(bitrate, std::memory_order_relaxed);
+    }
+}
+
+void FFmpegEncoder::apply_bitrate(int bitrate) {
+    int frame_ms = 1000 / std::max(1, config_.fps);
+    int vbv_ms = config_.vbv_buffer_ms > 0 ? config_.vbv_buffer_ms : std::max(1, frame_ms);
+    
+    codec_context_->bit_rate = bitrate;
+    codec_context_->rc_max_rate = bitrate;
+    codec_context_->rc_buffer_size = static_cast<int>(static_cast<int64_t>(bitrate) * vbv_ms / 1000);
+    current_bitrate_.store(bitrate, std::memory_order_relaxed);
+}
+
 std::vector<std::vector<uint8_t>> FFmpegEncoder::flush() {
     std::vector<std::vector<uint8_t>> packets;
     
@@ -203,9 +316,9 @@ void FFmpegEncoder::cleanup() {
 FFmpegEncoder::FFmpegEncoder(const EncoderConfig& config) {}
 FFmpegEncoder::~FFmpegEncoder() {}
 bool FFmpegEncoder::initialize() { return false; }
-std::vector<uint8_t> FFmpegEncoder::encode_frame(const uint8_t*, int, int) { return {}; }
+std::vector<uint8_t> FFmpegEncoder::encode_frame(const uint8_t*, int, int, PixelFormat, int) { return {}; }
 std::vector<std::vector<uint8_t>> FFmpegEncoder::flush() { return {}; }
 void FFmpegEncoder::cleanup() {}
 bool FFmpegEncoder::init_frame() { return false; }
-bool FFmpegEncoder::convert_frame(const uint8_t*, int, int) { return false; }
+bool FFmpegEncoder::convert_frame(const uint8_t*, int, int, PixelFormat, int) { return false; }
 #endif
\ No newline at end of file
@@ -3,15 +3,28 @@
 
 // FFmpeg kütüphaneleri varsa include et
 #ifdef FFMPEG_AVAILABLE
+extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavutil/imgutils.h>
 #include <libswscale/swscale.h>
+}
 #include <vector>
 #include <memory>
 #include <string>
+#include <atomic>
+#include <cstdint>
 
 class FFmpegEncoder {
 public:
+    // Layouts encode_frame accepts without a prior conversion pass
+    enum class PixelFormat {
+        BGR24,    // OpenCV default
+        RGB24,
+        NV12,     // Y plane, then interleaved UV
+        YUYV,     // Packed 4:2:2, the usual raw webcam format
+        YUV420P   // Encoder native; copied without conversion
+    };
+    
     struct EncoderConfig {
         int width;
         int height;
@@ -20,10 +33,15 @@ public:
         std::string codec_name;
         std::string preset;
         std::string tune;
+        int gop_size;          // Frames per refresh cycle; 0 = one second
+        bool intra_refresh;    // Refresh a moving column instead of sending IDRs
+        int vbv_buffer_ms;     // VBV size; 0 = one frame interval
+        int slice_max_size;    // Upper bound on slice NAL size in bytes; 0 = one slice
         
         EncoderConfig(int w, int h, int f, int b, const std::string& c = "libx264",
-                     const std::string& p = "veryfast", const std::string& t = "grain")
-            : width(w), height(h), fps(f), bitrate(b), codec_name(c), preset(p), tune(t) {}
+                     const std::string& p = "veryfast", const std::string& t = "zerolatency")
+            : width(w), height(h), fps(f), bitrate(b), codec_name(c), preset(p), tune(t),
+              gop_size(0), intra_refresh(true), vbv_buffer_ms(0), slice_max_size(0) {}
     };
     
     FFmpegEncoder(const EncoderConfig& config);
@@ -32,8 +50,10 @@ public:
     // Initialize encoder
     bool initialize();
     
-    // Encode a frame
-    std::vector<uint8_t> encode_frame(const uint8_t* frame_data, int width, int height);
+    // Encode a frame. stride is the byte length of one (luma) row, 0 for
+    // tightly packed rows; planar chroma follows the luma plane directly.
+    std::vector<uint8_t> encode_frame(const uint8_t* frame_data, int width, int height,
+                                      PixelFormat format = PixelFormat::RGB24, int stride = 0);
     
     // Flush encoder and get remaining packets
     std::vector<std::vector<uint8_t>> flush();
@@ -43,20 +63,42 @@ public:
     
     // Check if encoder is initialized
     bool is_initialized() const { return codec_context_ != nullptr; }
+    
+    // Whether the last frame returned by encode_frame is a keyframe
+    bool is_keyframe() const { return last_keyframe_; }
+    
+    // Change the target bitrate (bits/s). Safe from any thread; applied on
+    // the next encode_frame by reconfiguring the open encoder.
+    void set_bitrate(int bitrate);
+    int get_bitrate() const { return current_bitrate_.load(std::memory_order_relaxed); }
+    
+    // Code the next frame as an IDR. Safe from any thread.
+    void force_keyframe() { keyframe_requested_.store(true, std::memory_order_relaxed); }
 
 private:
     EncoderConfig config_;
-    AVCodec* codec_;
+    const AVCodec* codec_;
     AVCodecContext* codec_context_;
     AVFrame* frame_;
     AVPacket* packet_;
     SwsContext* sws_context_;
+    bool last_keyframe_;
+    int64_t next_pts_;
+    std::atomic<int> current_bitrate_;
+    std::atomic<int> pending_bitrate_;     // 0 = no change queued
+    std::atomic<bool> keyframe_requested_;
+    
+    // Set the rate control fields for a bitrate; libx264 compares them on
+    // every frame and reconfigures itself when they change
+    void apply_bitrate(int bitrate);
     
     // Initialize frame
     bool init_frame();
     
-    // Convert frame format if needed
-    bool convert_frame(const uint8_t* input_data, int width, int height);
+    // Convert frame format if needed; the scaler is rebuilt only when the
+    // input format or size changes
+    bool convert_frame(const uint8_t* input_data, int width, int height,
+                       PixelFormat format, int stride);
     
     // Cleanup resources
     void cleanup();
@@ -68,6 +110,8 @@ private:
 
 class FFmpegEncoder {
 public:
+    enum class PixelFormat { BGR24, RGB24, NV12, YUYV, YUV420P };
+    
     struct EncoderConfig {
         int width;
         int height;
@@ -76,19 +120,28 @@ public:
         std::string codec_name;
         std::string preset;
         std::string tune;
+        int gop_size;
+        bool intra_refresh;
+        int vbv_buffer_ms;
+        int slice_max_size;
         
         EncoderConfig(int w, int h, int f, int b, const std::string& c = "libx264",
-                     const std::string& p = "veryfast", const std::string& t = "grain")
-            : width(w), height(h), fps(f), bitrate(b), codec_name(c), preset(p), tune(t) {}
+                     const std::string& p = "veryfast", const std::string& t = "zerolatency")
+            : width(w), height(h), fps(f), bitrate(b), codec_name(c), preset(p), tune(t),
+              gop_size(0), intra_refresh(true), vbv_buffer_ms(0), slice_max_size(0) {}
     };
     
     FFmpegEncoder(const EncoderConfig& config) {}
     ~FFmpegEncoder() {}
     
     bool initialize() { return false; }
-    std::vector<uint8_t> encode_frame(const uint8_t*, int, int) { return {}; }
+    std::vector<uint8_t> encode_frame(const uint8_t*, int, int, PixelFormat = PixelFormat::RGB24, int = 0) { return {}; }
     std::vector<std::vector<uint8_t>> flush() { return {}; }
     const EncoderConfig& get_config() const { static EncoderConfig c(0,0,0,0,"","",""); return c; }
     bool is_initialized() const { return false; }
+    bool is_keyframe() const { return false; }
+    void set_bitrate(int) {}
+    int get_bitrate() const { return 0; }
+    void force_keyframe() {}
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,315 @@
+// gf256.cpp
+#include "gf256.h"
+#include <cstring>
+#include <vector>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GF256_X86 1
+#endif
+
+namespace {
+
+using RegionFn = void (*)(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len);
+
+struct Tables {
+    uint8_t exp[512];
+    uint8_t log[256];
+    uint8_t mul[256][256];
+    // Split tables: nibble_lo[c][x] = c * x, nibble_hi[c][x] = c * (x << 4)
+    alignas(16) uint8_t nibble_lo[256][16];
+    alignas(16) uint8_t nibble_hi[256][16];
+
+    Tables() {
+        int x = 1;
+        for (int i = 0; i < 255; ++i) {
+            exp[i] = static_cast<uint8_t>(x);
+            log[x] = static_cast<uint8_t>(i);
+            x <<= 1;
+            if (x & 0x100) {
+                x ^= 0x11D;
+            }
+        }
+        for (int i = 255; i < 512; ++i) {
+            exp[i] = exp[i - 255];
+        }
+        log[0] = 0;
+
+        for (int a = 0; a < 256; ++a) {
+            for (int b = 0; b < 256; ++b) {
+                mul[a][b] = (a == 0 || b == 0) ? 0 : exp[log[a] + log[b]];
+            }
+        }
+
+        for (int c = 0; c < 256; ++c) {
+            for (int n = 0; n < 16; ++n) {
+                nibble_lo[c][n] = mul[c][n];
+                nibble_hi[c][n] = mul[c][n << 4];
+            }
+        }
+    }
+};
+
+const Tables& tables() {
+    static const Tables t;
+    return t;
+}
+
+void mul_add_scalar(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len) {
+    const uint8_t* row = tables().mul[c];
+    for (size_t i = 0; i < len; ++i) {
+        dst[i] ^= row[src[i]];
+    }
+}
+
+void mul_scalar(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len) {
+    const uint8_t* row = tables().mul[c];
+    for (size_t i = 0; i < len; ++i) {
+        dst[i] = row[src[i]];
+    }
+}
+
+#ifdef GF256_X86
+__attribute__((target("ssse3")))
+void mul_add_ssse3(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len) {
+    const Tables& t = tables();
+    const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(t.nibble_lo[c]));
+    const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(t.nibble_hi[c]));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(s, mask));
+        __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(s, 4), mask));
+        d = _mm_xor_si128(d, _mm_xor_si128(l, h));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), d);
+    }
+    mul_add_scalar(dst + i, src + i, c, len - i);
+}
+
+__attribute__((target("ssse3")))
+void mul_ssse3(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len) {
+    const Tables& t = tables();
+    const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(t.nibble_lo[c]));
+    const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(t.nibble_hi[c]));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(s, mask));
+        __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(s, 4), mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(l, h));
+    }
+    mul_scalar(dst + i, src + i, c, len - i);
+}
+
+__attribute__((target("avx2")))
+void mul_add_avx2(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len) {
+    const Tables& t = tables();
+    const __m256i lo = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(t.nibble_lo[c])));
+    const __m256i hi = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(t.nibble_hi[c])));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(s, mask));
+        __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(s, 4), mask));
+        d = _mm256_xor_si256(d, _mm256_xor_si256(l, h));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), d);
+    }
+    mul_add_ssse3(dst + i, src + i, c, len - i);
+}
+
+__attribute__((target("avx2")))
+void mul_avx2(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len) {
+    const Tables& t = tables();
+    const __m256i lo = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(t.nibble_lo[c])));
+    const __m256i hi = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(t.nibble_hi[c])));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(s, mask));
+        __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(s, 4), mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(l, h));
+    }
+    mul_ssse3(dst + i, src + i, c, len - i);
+}
+#endif
+
+bool cpu_supports(GF256::Kernel kernel) {
+#ifdef GF256_X86
+    switch (kernel) {
+        case GF256::AVX2: return __builtin_cpu_supports("avx2");
+        case GF256::SSSE3: return __builtin_cpu_supports("ssse3");
+        default: return true;
+    }
+#else
+    return kernel == GF256::SCALAR;
+#endif
+}
+
+struct Dispatch {
+    std::atomic<GF256::Kernel> kernel;
+    std::atomic<RegionFn> mul_add;
+    std::atomic<RegionFn> mul;
+
+    Dispatch() {
+        if (cpu_supports(GF256::AVX2)) {
+            select(GF256::AVX2);
+        } else if (cpu_supports(GF256::SSSE3)) {
+            select(GF256::SSSE3);
+        } else {
+            select(GF256::SCALAR);
+        }
+    }
+
+    void select(GF256::Kernel k) {
+        switch (k) {
+#ifdef GF256_X86
+            case GF256::AVX2:
+                mul_add = mul_add_avx2;
+                mul = mul_avx2;
+                break;
+            case GF256::SSSE3:
+                mul_add = mul_add_ssse3;
+                mul = mul_ssse3;
+                break;
+#endif
+            default:
+                k = GF256::SCALAR;
+                mul_add = mul_add_scalar;
+                mul = mul_scalar;
+                break;
+        }
+        kernel = k;
+    }
+};
+
+Dispatch& dispatch() {
+    static Dispatch d;
+    return d;
+}
+
+} // namespace
+
+uint8_t GF256::mul(uint8_t a, uint8_t b) {
+    return tables().mul[a][b];
+}
+
+uint8_t GF256::inv(uint8_t a) {
+    if (a == 0) {
+        return 0;
+    }
+    const Tables& t = tables();
+    return t.exp[255 - t.log[a]];
+}
+
+uint8_t GF256::div(uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    const Tables& t = tables();
+    return t.exp[t.log[a] + 255 - t.log[b]];
+}
+
+void GF256::mul_add_region(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len) {
+    if (c == 0 || len == 0) {
+        return;
+    }
+    if (c == 1) {
+        for (size_t i = 0; i < len; ++i) {
+            dst[i] ^= src[i];
+        }
+        return;
+    }
+    dispatch().mul_add.load(std::memory_order_relaxed)(dst, src, c, len);
+}
+
+void GF256::mul_region(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    if (c == 0) {
+        std::memset(dst, 0, len);
+        return;
+    }
+    if (c == 1) {
+        if (dst != src) {
+            std::memmove(dst, src, len);
+        }
+        return;
+    }
+    dispatch().mul.load(std::memory_order_relaxed)(dst, src, c, len);
+}
+
+bool GF256::invert_matrix(uint8_t* matrix, int n) {
+    // Gauss-Jordan elimination on [A | I]
+    std::vector<uint8_t> inverse(n * n, 0);
+    for (int i = 0; i < n; ++i) {
+        inverse[i * n + i] = 1;
+    }
+
+    for (int col = 0; col < n; ++col) {
+        // Find pivot
+        int pivot = col;
+        while (pivot < n && matrix[pivot * n + col] == 0) {
+            pivot++;
+        }
+        if (pivot == n) {
+            return false;
+        }
+
+        if (pivot != col) {
+            for (int j = 0; j < n; ++j) {
+                std::swap(matrix[pivot * n + j], matrix[col * n + j]);
+                std::swap(inverse[pivot * n + j], inverse[col * n + j]);
+            }
+        }
+
+        // Normalize pivot row
+        uint8_t pivot_inv = inv(matrix[col * n + col]);
+        mul_region(&matrix[col * n], &matrix[col * n], pivot_inv, n);
+        mul_region(&inverse[col * n], &inverse[col * n], pivot_inv, n);
+
+        // Eliminate column from other rows
+        for (int row = 0; row < n; ++row) {
+            uint8_t factor = matrix[row * n + col];
+            if (row == col || factor == 0) {
+                continue;
+            }
+            mul_add_region(&matrix[row * n], &matrix[col * n], factor, n);
+            mul_add_region(&inverse[row * n], &inverse[col * n], factor, n);
+        }
+    }
+
+    std::memcpy(matrix, inverse.data(), n * n);
+    return true;
+}
+
+GF256::Kernel GF256::kernel() {
+    return dispatch().kernel.load();
+}
+
+const char* GF256::kernel_name() {
+    switch (kernel()) {
+        case AVX2: return "avx2";
+        case SSSE3: return "ssse3";
+        default: return "scalar";
+    }
+}
+
+void GF256::set_kernel(Kernel kernel) {
+    dispatch().select(cpu_supports(kernel) ? kernel : SCALAR);
+}
@@ -0,0 +1,38 @@
+// gf256.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// GF(2^8) arithmetic over the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11D).
+// Region operations use split nibble tables (PSHUFB) on SSSE3/AVX2 capable
+// CPUs and fall back to a full multiplication table otherwise. The kernel
+// is selected once at runtime.
+class GF256 {
+public:
+    enum Kernel {
+        SCALAR,
+        SSSE3,
+        AVX2
+    };
+
+    static uint8_t add(uint8_t a, uint8_t b) { return a ^ b; }
+    static uint8_t mul(uint8_t a, uint8_t b);
+    static uint8_t div(uint8_t a, uint8_t b);
+    static uint8_t inv(uint8_t a);
+
+    // dst[i] ^= c * src[i]
+    static void mul_add_region(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len);
+
+    // dst[i] = c * src[i]
+    static void mul_region(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len);
+
+    // Invert an n x n row-major matrix in place. Returns false if singular.
+    static bool invert_matrix(uint8_t* matrix, int n);
+
+    // Active region kernel
+    static Kernel kernel();
+    static const char* kernel_name();
+
+    // Force a kernel (falls back to SCALAR if the CPU lacks support)
+    static void set_kernel(Kernel kernel);
+};
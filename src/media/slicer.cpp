@@ -1,4 +1,5 @@
 #include "slicer.h"
+#include "../transport/packet_header.h"
 #include <algorithm>
 #include <cstring>
 #include <stdexcept>
@@ -53,7 +54,8 @@ std::vector<uint8_t> Slicer::unslice(const std::vector<std::vector<uint8_t>>& ch
 }
 
 std::vector<std::vector<uint8_t>> Slicer::slice_with_header(const std::vector<uint8_t>& data, 
-                                                           uint32_t sequence_number) {
+                                                           uint32_t sequence_number,
+                                                           uint32_t timestamp) {
     if (data.empty()) {
         return {};
     }
@@ -66,23 +68,16 @@ std::vector<std::vector<uint8_t>> Slicer::slice_with_header(const std::vector<ui
         size_t chunk_size = std::min(max_chunk_size_, data.size() - offset);
         
         // Create chunk with header
-        std::vector<uint8_t> chunk;
-        chunk.reserve(12 + chunk_size); // Header + data
+        std::vector<uint8_t> chunk(DataHeader::kSize);
+        chunk.reserve(DataHeader::kSize + chunk_size); // Header + data
         
-        // Header: 12 bytes
-        // - sequence_number (4 bytes)
-        // - chunk_id (2 bytes)
-        // - total_chunks (2 bytes)
-        // - chunk_size (2 bytes)
-        // - reserved (2 bytes)
-        
-        uint16_t total_chunks = (data.size() + max_chunk_size_ - 1) / max_chunk_size_;
-        
-        chunk.insert(chunk.end(), (uint8_t*)&sequence_number, (uint8_t*)&sequence_number + 4);
-        chunk.insert(chunk.end(), (uint8_t*)&chunk_id, (uint8_t*)&chunk_id + 2);
-        chunk.insert(chunk.end(), (uint8_t*)&total_chunks, (uint8_t*)&total_chunks + 2);
-        chunk.insert(chunk.end(), (uint8_t*)&chunk_size, (uint8_t*)&chunk_size + 2);
-        chunk.insert(chunk.end(), 2, 0); // Reserved bytes
+        DataHeader header;
+        header.sequence_number = sequence_number;
+        header.chunk_id = chunk_id;
+        header.total_chunks = static_cast<uint16_t>((data.size() + max_chunk_size_ - 1) / max_chunk_size_);
+        header.chunk_size = static_cast<uint16_t>(chunk_size);
+        header.timestamp = timestamp;
+        header.write(chunk.data());
         
         // Add data
         chunk.insert(chunk.end(), data.begin() + offset, data.begin() + offset + chunk_size);
@@ -96,6 +91,80 @@ std::vector<std::vector<uint8_t>> Slicer::slice_with_header(const std::vector<ui
     return chunks;
 }
 
+std::vector<std::vector<uint8_t>> Slicer::slice_nal_aligned(const std::vector<uint8_t>& data,
+                                                           uint32_t sequence_number,
+                                                           std::vector<uint8_t>& layout,
+                                                           uint32_t timestamp) {
+    layout.clear();
+    if (data.empty()) {
+        return {};
+    }
+    
+    // NAL unit starts, each including its start code (a 4-byte start code
+    // begins one byte before the 00 00 01 found here)
+    std::vector<size_t> boundaries;
+    for (size_t i = 0; i + 2 < data.size(); ++i) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            size_t start = (i > 0 && data[i - 1] == 0) ? i - 1 : i;
+            if (start > 0) {
+                boundaries.push_back(start);
+            }
+            i += 2;
+        }
+    }
+    boundaries.push_back(data.size());
+    
+    // Cut each chunk at the last NAL boundary that fits
+    std::vector<size_t> ends;
+    size_t offset = 0;
+    size_t next = 0;
+    while (offset < data.size()) {
+        size_t limit = std::min(offset + max_chunk_size_, data.size());
+        size_t end = offset;
+        while (next < boundaries.size() && boundaries[next] <= limit) {
+            end = boundaries[next++];
+        }
+        if (end <= offset) {
+            end = limit;  // NAL larger than a chunk
+        }
+        ends.push_back(end);
+        offset = end;
+    }
+    
+    std::vector<std::vector<uint8_t>> chunks;
+    chunks.reserve(ends.size());
+    layout.assign((ends.size() - 1) * max_chunk_size_, 0);
+    
+    DataHeader header;
+    header.sequence_number = sequence_number;
+    header.total_chunks = static_cast<uint16_t>(ends.size());
+    header.timestamp = timestamp;
+    
+    offset = 0;
+    for (size_t i = 0; i < ends.size(); ++i) {
+        size_t chunk_size = ends[i] - offset;
+        
+        std::vector<uint8_t> chunk(DataHeader::kSize);
+        chunk.reserve(DataHeader::kSize + chunk_size);
+        header.chunk_id = static_cast<uint16_t>(i);
+        header.chunk_size = static_cast<uint16_t>(chunk_size);
+        header.write(chunk.data());
+        chunk.insert(chunk.end(), data.begin() + offset, data.begin() + ends[i]);
+        chunks.push_back(std::move(chunk));
+        
+        // The last chunk is not padded, so layout ends where the data does
+        if (i + 1 < ends.size()) {
+            std::copy(data.begin() + offset, data.begin() + ends[i],
+                      layout.begin() + i * max_chunk_size_);
+        } else {
+            layout.insert(layout.end(), data.begin() + offset, data.end());
+        }
+        offset = ends[i];
+    }
+    
+    return chunks;
+}
+
 std::vector<uint8_t> Slicer::unslice_with_header(const std::vector<std::vector<uint8_t>>& chunks) {
     if (chunks.empty()) {
         return {};
@@ -104,12 +173,12 @@ std::vector<uint8_t> Slicer::unslice_with_header(const std::vector<std::vector<u
     std::vector<uint8_t> result;
     
     for (const auto& chunk : chunks) {
-        if (chunk.size() < 12) {
+        if (chunk.size() < DataHeader::kSize) {
             throw std::runtime_error("Chunk too small for header");
         }
         
-        // Skip header (12 bytes) and add data
-        result.insert(result.end(), chunk.begin() + 12, chunk.end());
+        // Skip header and add data
+        result.insert(result.end(), chunk.begin() + DataHeader::kSize, chunk.end());
     }
     
     return result;
@@ -14,13 +14,26 @@ public:
     // Unslice chunks back to data
     std::vector<uint8_t> unslice(const std::vector<std::vector<uint8_t>>& chunks);
     
-    // Slice data with header information
+    // Slice data with header information; timestamp is the frame's
+    // capture time on the 90 kHz media clock
     std::vector<std::vector<uint8_t>> slice_with_header(const std::vector<uint8_t>& data, 
-                                                       uint32_t sequence_number);
+                                                       uint32_t sequence_number,
+                                                       uint32_t timestamp = 0);
     
     // Unslice chunks with header
     std::vector<uint8_t> unslice_with_header(const std::vector<std::vector<uint8_t>>& chunks);
     
+    // Slice an Annex B access unit so that chunks start on NAL unit
+    // boundaries: whole NAL units are packed into each chunk, and only a NAL
+    // larger than a chunk is cut. Chunk i is placed at i * max_chunk_size in
+    // layout, zero padded in between, which is the byte image FEC protects
+    // (a rebuilt chunk keeps its padding, harmless trailing zeros in Annex B).
+    // Data without start codes is sliced as by slice_with_header.
+    std::vector<std::vector<uint8_t>> slice_nal_aligned(const std::vector<uint8_t>& data,
+                                                        uint32_t sequence_number,
+                                                        std::vector<uint8_t>& layout,
+                                                        uint32_t timestamp = 0);
+    
     // Get/set max chunk size
     size_t get_max_chunk_size() const;
     void set_max_chunk_size(size_t size);
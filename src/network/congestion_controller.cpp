@@ -0,0 +1,486 @@
+// src/network/congestion_controller.cpp
+#include "congestion_controller.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Overuse detector (GCC defaults)
+constexpr double kThresholdUpGain = 0.0087;
+constexpr double kThresholdDownGain = 0.039;
+constexpr double kMinThresholdMs = 6.0;
+constexpr double kMaxThresholdMs = 600.0;
+constexpr double kMaxThresholdJumpMs = 15.0;
+constexpr double kOverusingTimeMs = 10.0;
+constexpr int kMaxDeltas = 60;
+
+// Acknowledged rate window
+constexpr int64_t kAckedWindowUs = 500000;
+
+// Loss-based control
+constexpr double kHighLoss = 0.10;
+constexpr double kLowLoss = 0.02;
+constexpr uint64_t kMinLossSamples = 20;
+
+// Feedback older than this no longer describes the path
+constexpr std::chrono::seconds kFeedbackTimeout(1);
+
+double seconds_between(std::chrono::steady_clock::time_point from,
+                       std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double>(to - from).count();
+}
+
+} // namespace
+
+CongestionController::CongestionController(const Config& config)
+    : config_(config), have_group_(false), current_group_(), have_previous_group_(false),
+      previous_group_(), first_arrival_us_(0), num_deltas_(0), accumulated_delay_ms_(0.0),
+      smoothed_delay_ms_(0.0), threshold_ms_(config.initial_threshold_ms), previous_trend_(0.0),
+      time_over_using_ms_(-1.0), overuse_count_(0), usage_(BandwidthUsage::NORMAL),
+      last_threshold_update_ms_(-1.0), rate_state_(RateState::HOLD),
+      delay_based_bitrate_(config.start_bitrate), link_capacity_bps_(0.0),
+      link_capacity_var_(0.4), loss_based_bitrate_(config.start_bitrate),
+      loss_window_received_(0), loss_window_lost_(0), in_loss_burst_(false),
+      acked_bytes_(0), have_first_ack_(false), first_ack_us_(0), acked_bitrate_(0),
+      have_report_sequence_(false), next_report_sequence_(0), rtt_ms_(0.0),
+      target_bitrate_(config.start_bitrate) {
+
+    if (config.min_bitrate <= 0 || config.max_bitrate < config.min_bitrate ||
+        config.trendline_window < 2 || config.fps <= 0) {
+        throw std::invalid_argument("Geçersiz congestion controller ayarları");
+    }
+    target_bitrate_ = clamp_bitrate(target_bitrate_);
+    delay_based_bitrate_ = target_bitrate_;
+    loss_based_bitrate_ = target_bitrate_;
+}
+
+void CongestionController::on_packet_sent(uint32_t sequence_number, uint16_t packet_id,
+                                          size_t size, Clock::time_point send_time) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    SentPacket& packet = history_[key_for(sequence_number, packet_id)];
+    packet.send_time = send_time;
+    packet.size = size;
+    packet.acknowledged = false;
+
+    // Packets feedback can no longer match are forgotten uncounted
+    auto max_age = std::chrono::milliseconds(config_.history_ms);
+    while (!history_.empty() && send_time - history_.begin()->second.send_time > max_age) {
+        history_.erase(history_.begin());
+    }
+}
+
+bool CongestionController::on_feedback(const FeedbackHeader& report, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Packets only a lost report could have acknowledged must not count as lost
+    bool report_lost = have_report_sequence_ && report.report_sequence != next_report_sequence_;
+    have_report_sequence_ = true;
+    next_report_sequence_ = report.report_sequence + 1;
+    last_feedback_ = now;
+    if (loss_window_start_ == Clock::time_point()) {
+        loss_window_start_ = now;
+    }
+
+    bool have_newest = false;
+    uint32_t newest_sequence = 0;
+    const SentPacket* last_matched = nullptr;
+    uint32_t last_matched_offset_us = 0;
+
+    // Entries are in arrival order
+    for (const auto& entry : report.entries) {
+        auto it = history_.find(key_for(entry.sequence_number, entry.packet_id));
+        if (it == history_.end() || it->second.acknowledged) {
+            continue;
+        }
+        SentPacket& packet = it->second;
+        packet.acknowledged = true;
+        last_matched = &packet;
+        last_matched_offset_us = entry.arrival_offset_us;
+
+        int64_t arrival_us = static_cast<int64_t>(report.base_time_us) + entry.arrival_offset_us;
+        update_acked_bitrate(arrival_us, packet.size);
+
+        if (!have_newest || static_cast<int32_t>(entry.sequence_number - newest_sequence) > 0) {
+            have_newest = true;
+            newest_sequence = entry.sequence_number;
+        }
+
+        // A packet of a newer frame closes the current group; stragglers of
+        // older frames are left out of the delay gradient
+        if (!have_group_) {
+            current_group_ = {entry.sequence_number, packet.send_time, arrival_us};
+            have_group_ = true;
+        } else if (entry.sequence_number == current_group_.sequence_number) {
+            current_group_.send_time = std::max(current_group_.send_time, packet.send_time);
+            current_group_.arrival_us = std::max(current_group_.arrival_us, arrival_us);
+        } else if (static_cast<int32_t>(entry.sequence_number - current_group_.sequence_number) > 0) {
+            on_group_complete(current_group_);
+            current_group_ = {entry.sequence_number, packet.send_time, arrival_us};
+        }
+    }
+
+    // The receiver held the last matched packet from its arrival until the
+    // report went out: the report delay plus any later arrivals
+    if (last_matched && !report.entries.empty()) {
+        double held_ms = (report.report_delay_us +
+                          (report.entries.back().arrival_offset_us - last_matched_offset_us)) / 1000.0;
+        double sample_ms = std::chrono::duration<double, std::milli>(now - last_matched->send_time).count() - held_ms;
+        if (sample_ms > 0) {
+            rtt_ms_ = rtt_ms_ > 0 ? rtt_ms_ + (sample_ms - rtt_ms_) / 8.0 : sample_ms;
+        }
+    }
+
+    if (have_newest) {
+        detect_losses(newest_sequence, !report_lost);
+    }
+
+    int64_t previous_target = target_bitrate_;
+    update_delay_based(now);
+    update_loss_based(now);
+    target_bitrate_ = clamp_bitrate(std::min(delay_based_bitrate_, loss_based_bitrate_));
+    return target_bitrate_ != previous_target;
+}
+
+void CongestionController::on_group_complete(const PacketGroup& group) {
+    if (!have_previous_group_) {
+        previous_group_ = group;
+        have_previous_group_ = true;
+        first_arrival_us_ = group.arrival_us;
+        return;
+    }
+
+    double send_delta_ms = std::chrono::duration<double, std::milli>(
+        group.send_time - previous_group_.send_time).count();
+    double arrival_delta_ms = (group.arrival_us - previous_group_.arrival_us) / 1000.0;
+    previous_group_ = group;
+    if (send_delta_ms < 0) {
+        return;
+    }
+
+    // Growth in one-way delay between consecutive send bursts
+    double delay_delta_ms = arrival_delta_ms - send_delta_ms;
+    num_deltas_ = std::min(num_deltas_ + 1, 1000);
+    accumulated_delay_ms_ += delay_delta_ms;
+    smoothed_delay_ms_ = config_.trendline_smoothing * smoothed_delay_ms_ +
+                         (1.0 - config_.trendline_smoothing) * accumulated_delay_ms_;
+
+    double arrival_ms = (group.arrival_us - first_arrival_us_) / 1000.0;
+    delay_samples_.emplace_back(arrival_ms, smoothed_delay_ms_);
+    if (delay_samples_.size() > static_cast<size_t>(config_.trendline_window)) {
+        delay_samples_.pop_front();
+    }
+
+    double trend = previous_trend_;
+    if (delay_samples_.size() == static_cast<size_t>(config_.trendline_window)) {
+        trend = trendline_slope() * std::min(num_deltas_, kMaxDeltas) * config_.trendline_gain;
+    }
+    detect(trend, send_delta_ms, arrival_ms);
+}
+
+double CongestionController::trendline_slope() const {
+    // Least squares slope of smoothed delay over arrival time
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    for (const auto& sample : delay_samples_) {
+        mean_x += sample.first;
+        mean_y += sample.second;
+    }
+    mean_x /= delay_samples_.size();
+    mean_y /= delay_samples_.size();
+
+    double numerator = 0.0;
+    double denominator = 0.0;
+    for (const auto& sample : delay_samples_) {
+        double dx = sample.first - mean_x;
+        numerator += dx * (sample.second - mean_y);
+        denominator += dx * dx;
+    }
+    return denominator != 0.0 ? numerator / denominator : 0.0;
+}
+
+void CongestionController::detect(double trend, double send_delta_ms, double arrival_ms) {
+    if (num_deltas_ < 2) {
+        usage_ = BandwidthUsage::NORMAL;
+        return;
+    }
+
+    if (trend > threshold_ms_) {
+        // Overuse must persist for a while and keep growing before it counts
+        if (time_over_using_ms_ < 0) {
+            time_over_using_ms_ = send_delta_ms / 2;
+        } else {
+            time_over_using_ms_ += send_delta_ms;
+        }
+        overuse_count_++;
+        if (time_over_using_ms_ > kOverusingTimeMs && overuse_count_ > 1 && trend >= previous_trend_) {
+            time_over_using_ms_ = 0;
+            overuse_count_ = 0;
+            usage_ = BandwidthUsage::OVERUSING;
+        }
+    } else if (trend < -threshold_ms_) {
+        time_over_using_ms_ = -1;
+        overuse_count_ = 0;
+        usage_ = BandwidthUsage::UNDERUSING;
+    } else {
+        time_over_using_ms_ = -1;
+        overuse_count_ = 0;
+        usage_ = BandwidthUsage::NORMAL;
+    }
+    previous_trend_ = trend;
+
+    update_threshold(trend, arrival_ms);
+}
+
+void CongestionController::update_threshold(double trend, double arrival_ms) {
+    if (last_threshold_update_ms_ < 0) {
+        last_threshold_update_ms_ = arrival_ms;
+    }
+
+    // Spikes far above the threshold (e.g. a route change) are not learnt
+    double magnitude = std::fabs(trend);
+    if (magnitude > threshold_ms_ + kMaxThresholdJumpMs) {
+        last_threshold_update_ms_ = arrival_ms;
+        return;
+    }
+
+    // The threshold follows the trend, slowly upwards and faster downwards,
+    // so competing loss-based flows do not starve this one
+    double gain = magnitude < threshold_ms_ ? kThresholdDownGain : kThresholdUpGain;
+    double elapsed_ms = std::min(arrival_ms - last_threshold_update_ms_, 100.0);
+    threshold_ms_ += gain * (magnitude - threshold_ms_) * elapsed_ms;
+    threshold_ms_ = std::max(kMinThresholdMs, std::min(threshold_ms_, kMaxThresholdMs));
+    last_threshold_update_ms_ = arrival_ms;
+}
+
+void CongestionController::update_acked_bitrate(int64_t arrival_us, size_t size) {
+    if (!have_first_ack_) {
+        have_first_ack_ = true;
+        first_ack_us_ = arrival_us;
+    }
+
+    acked_.emplace_back(arrival_us, size);
+    acked_bytes_ += size;
+    while (!acked_.empty() && arrival_us - acked_.front().first > kAckedWindowUs) {
+        acked_bytes_ -= acked_.front().second;
+        acked_.pop_front();
+    }
+
+    // Known once a whole window has been observed
+    if (arrival_us - first_ack_us_ >= kAckedWindowUs) {
+        acked_bitrate_ = static_cast<int64_t>(acked_bytes_) * 8 * 1000000 / kAckedWindowUs;
+    }
+}
+
+void CongestionController::detect_losses(uint32_t newest_sequence, bool count) {
+    // Frames two or more behind the newest acknowledged one are settled;
+    // anything of theirs not acknowledged by now was lost
+    auto it = history_.begin();
+    while (it != history_.end()) {
+        uint32_t sequence_number = static_cast<uint32_t>(it->first >> 16);
+        if (static_cast<int32_t>(newest_sequence - sequence_number) < 2) {
+            break;
+        }
+
+        if (count) {
+            if (it->second.acknowledged) {
+                loss_counts_.received++;
+                loss_window_received_++;
+                in_loss_burst_ = false;
+            } else {
+                loss_counts_.lost++;
+                loss_window_lost_++;
+                if (!in_loss_burst_) {
+                    loss_counts_.bursts++;
+                    in_loss_burst_ = true;
+                }
+            }
+        }
+        it = history_.erase(it);
+    }
+}
+
+void CongestionController::update_delay_based(Clock::time_point now) {
+    switch (usage_) {
+        case BandwidthUsage::OVERUSING:
+            rate_state_ = RateState::DECREASE;
+            break;
+        case BandwidthUsage::UNDERUSING:
+            // Queues are draining; hold until they are empty
+            rate_state_ = RateState::HOLD;
+            break;
+        case BandwidthUsage::NORMAL:
+            if (rate_state_ == RateState::HOLD) {
+                rate_state_ = RateState::INCREASE;
+            }
+            break;
+    }
+
+    double elapsed_s = last_rate_update_ == Clock::time_point()
+                           ? 0.0 : std::min(1.0, seconds_between(last_rate_update_, now));
+    last_rate_update_ = now;
+
+    double rate = static_cast<double>(delay_based_bitrate_);
+    double acked = static_cast<double>(acked_bitrate_);
+    double capacity_std = std::sqrt(link_capacity_var_ * link_capacity_bps_);
+
+    switch (rate_state_) {
+        case RateState::HOLD:
+            break;
+
+        case RateState::INCREASE:
+            // The link got faster than the last estimate; probe again
+            if (link_capacity_bps_ > 0 && acked > link_capacity_bps_ + 3 * capacity_std) {
+                link_capacity_bps_ = 0;
+            }
+            if (link_capacity_bps_ > 0) {
+                // Near capacity: about one packet per frame per response time
+                double bits_per_frame = rate / config_.fps;
+                double packets_per_frame = std::ceil(bits_per_frame / (1200.0 * 8.0));
+                double packet_bits = bits_per_frame / std::max(1.0, packets_per_frame);
+                double increase = std::max(4000.0, packet_bits * 1000.0 / config_.response_time_ms);
+                rate += increase * elapsed_s;
+            } else {
+                rate += std::max(rate * (std::pow(1.08, elapsed_s) - 1.0), 1000.0 * elapsed_s);
+            }
+            break;
+
+        case RateState::DECREASE:
+            if (acked > 0) {
+                rate = std::min(rate, config_.beta * acked);
+
+                // Capacity estimate: average of the acked rate at overuse
+                if (link_capacity_bps_ > 0 && acked < link_capacity_bps_ - 3 * capacity_std) {
+                    link_capacity_bps_ = 0;
+                }
+                if (link_capacity_bps_ == 0) {
+                    link_capacity_bps_ = acked;
+                } else {
+                    link_capacity_bps_ = 0.95 * link_capacity_bps_ + 0.05 * acked;
+                }
+                double error = link_capacity_bps_ - acked;
+                link_capacity_var_ = 0.95 * link_capacity_var_ +
+                                     0.05 * error * error / std::max(link_capacity_bps_, 1.0);
+                link_capacity_var_ = std::max(0.4, std::min(link_capacity_var_, 2.5));
+            } else {
+                rate *= config_.beta;
+            }
+            rate_state_ = RateState::HOLD;
+            break;
+    }
+
+    // Never run far ahead of what the path has been seen to carry
+    if (acked > 0) {
+        rate = std::min(rate, 1.5 * acked + 10000.0);
+    }
+    delay_based_bitrate_ = clamp_bitrate(static_cast<int64_t>(rate));
+}
+
+void CongestionController::update_loss_based(Clock::time_point now) {
+    uint64_t samples = loss_window_received_ + loss_window_lost_;
+    double elapsed_s = seconds_between(loss_window_start_, now);
+    if (samples < kMinLossSamples && elapsed_s < 1.0) {
+        return;
+    }
+
+    if (samples > 0) {
+        double loss = static_cast<double>(loss_window_lost_) / samples;
+        if (loss > kHighLoss) {
+            loss_based_bitrate_ = static_cast<int64_t>(target_bitrate_ * (1.0 - 0.5 * loss));
+        } else if (loss < kLowLoss) {
+            double base = static_cast<double>(std::max(loss_based_bitrate_, target_bitrate_));
+            loss_based_bitrate_ = static_cast<int64_t>(base * std::pow(1.05, std::min(1.0, elapsed_s)));
+        }
+        loss_based_bitrate_ = clamp_bitrate(loss_based_bitrate_);
+    }
+
+    loss_window_received_ = 0;
+    loss_window_lost_ = 0;
+    loss_window_start_ = now;
+}
+
+int64_t CongestionController::clamp_bitrate(int64_t bitrate) const {
+    return std::max(config_.min_bitrate, std::min(bitrate, config_.max_bitrate));
+}
+
+int64_t CongestionController::get_target_bitrate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return target_bitrate_;
+}
+
+int64_t CongestionController::get_acknowledged_bitrate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return acked_bitrate_;
+}
+
+double CongestionController::get_rtt_ms() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rtt_ms_;
+}
+
+bool CongestionController::has_recent_feedback(Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return have_report_sequence_ && now - last_feedback_ < kFeedbackTimeout;
+}
+
+CongestionController::BandwidthUsage CongestionController::get_bandwidth_usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usage_;
+}
+
+CongestionController::LossCounts CongestionController::take_loss_counts() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LossCounts counts = loss_counts_;
+    loss_counts_ = LossCounts();
+    return counts;
+}
+
+FeedbackReporter::FeedbackReporter(size_t max_datagram_size, std::chrono::milliseconds interval)
+    : max_entries_(std::min<size_t>(FeedbackHeader::max_entries(max_datagram_size), 0xFFFF)),
+      interval_(interval), next_report_sequence_(0) {
+
+    if (max_entries_ == 0) {
+        throw std::invalid_argument("Feedback paketi için datagram boyutu çok küçük");
+    }
+    report_.entries.reserve(max_entries_);
+}
+
+bool FeedbackReporter::on_packet(const uint8_t* data, size_t size, Clock::time_point arrival) {
+    FeedbackHeader::Entry entry;
+    if (!feedback_packet_id(data, size, entry.sequence_number, entry.packet_id)) {
+        return false;
+    }
+
+    if (report_.entries.empty()) {
+        base_time_ = arrival;
+        if (last_report_ == Clock::time_point()) {
+            last_report_ = arrival;
+        }
+    }
+    entry.arrival_offset_us = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(arrival - base_time_).count());
+    report_.entries.push_back(entry);
+    last_arrival_ = arrival;
+
+    return report_.entries.size() >= max_entries_ || arrival - last_report_ >= interval_;
+}
+
+bool FeedbackReporter::build_report(std::vector<uint8_t>& out) {
+    if (report_.entries.empty()) {
+        return false;
+    }
+
+    auto now = Clock::now();
+    report_.report_sequence = next_report_sequence_++;
+    report_.report_delay_us = static_cast<uint32_t>(std::max<int64_t>(
+        0, std::chrono::duration_cast<std::chrono::microseconds>(now - last_arrival_).count()));
+    report_.base_time_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(base_time_.time_since_epoch()).count());
+    out.resize(report_.size());
+    report_.write(out.data());
+
+    report_.entries.clear();
+    last_report_ = now;
+    return true;
+}
@@ -0,0 +1,195 @@
+// src/network/congestion_controller.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "../transport/packet_header.h"
+
+// Send-side bandwidth estimation in the style of Google Congestion Control.
+// The sender keeps a history of media packets; the receiver reports their
+// arrival times (FeedbackReporter) and the controller combines:
+//
+// - a delay-based estimate: packets are grouped per frame (one send burst),
+//   the change in one-way delay between groups is run through a trendline
+//   filter, and an adaptive threshold on the trend signals overuse or
+//   underuse. The rate follows AIMD: multiplicative increase far from the
+//   last known link capacity, additive increase near it, and a cut to 85%
+//   of the acknowledged rate on overuse.
+// - a loss-based bound: above 10% loss the rate is cut by half the loss
+//   fraction, below 2% it may grow again by 5% per second.
+//
+// The target is the lower of the two, within [min_bitrate, max_bitrate].
+//
+// Each report also yields a round-trip sample: the time since the newest
+// acknowledged packet was sent, less the time the receiver held it before
+// reporting.
+class CongestionController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class BandwidthUsage { NORMAL, UNDERUSING, OVERUSING };
+
+    struct Config {
+        int64_t start_bitrate;       // bits/s
+        int64_t min_bitrate;
+        int64_t max_bitrate;
+        int trendline_window;        // delay samples in the regression
+        double trendline_smoothing;  // EMA coefficient for accumulated delay
+        double trendline_gain;
+        double initial_threshold_ms;
+        double beta;                 // decrease factor on overuse
+        int response_time_ms;        // time for a rate change to show in delay
+        int history_ms;              // sent packets kept for feedback matching
+        int fps;                     // frames (send bursts) per second, sizes the additive increase
+
+        Config() : start_bitrate(3000000), min_bitrate(300000), max_bitrate(10000000),
+                   trendline_window(20), trendline_smoothing(0.9), trendline_gain(4.0),
+                   initial_threshold_ms(12.5), beta(0.85), response_time_ms(200),
+                   history_ms(2000), fps(30) {}
+    };
+
+    explicit CongestionController(const Config& config = Config());
+
+    // Record a media packet as it is handed to the socket
+    void on_packet_sent(uint32_t sequence_number, uint16_t packet_id, size_t size,
+                        Clock::time_point send_time);
+
+    // Process a feedback report; returns true if the target changed
+    bool on_feedback(const FeedbackHeader& report, Clock::time_point now);
+
+    // Current target send rate in bits/s, media and parity together
+    int64_t get_target_bitrate() const;
+
+    // Rate the receiver acknowledged over the last half second, 0 until known
+    int64_t get_acknowledged_bitrate() const;
+
+    // Smoothed round-trip time of the path in ms, 0 until measured
+    double get_rtt_ms() const;
+
+    // Whether feedback arrived recently enough for the target to be current
+    bool has_recent_feedback(Clock::time_point now) const;
+
+    BandwidthUsage get_bandwidth_usage() const;
+
+    // Packet fates learnt from feedback since the last call; losses reported
+    // back to back count as one burst
+    struct LossCounts {
+        uint64_t received = 0;
+        uint64_t lost = 0;
+        uint64_t bursts = 0;
+    };
+    LossCounts take_loss_counts();
+
+private:
+    enum class RateState { HOLD, INCREASE, DECREASE };
+
+    struct SentPacket {
+        Clock::time_point send_time;
+        size_t size;
+        bool acknowledged;
+    };
+
+    // One frame's packets, the unit of the delay gradient
+    struct PacketGroup {
+        uint32_t sequence_number;
+        Clock::time_point send_time;  // last packet, sender clock
+        int64_t arrival_us;           // last packet, receiver clock
+    };
+
+    Config config_;
+    mutable std::mutex mutex_;
+
+    // (sequence_number << 16 | packet_id), roughly in send order
+    std::map<uint64_t, SentPacket> history_;
+
+    // Trendline filter
+    bool have_group_;
+    PacketGroup current_group_;
+    bool have_previous_group_;
+    PacketGroup previous_group_;
+    int64_t first_arrival_us_;
+    int num_deltas_;
+    double accumulated_delay_ms_;
+    double smoothed_delay_ms_;
+    std::deque<std::pair<double, double>> delay_samples_;  // (arrival ms, smoothed delay)
+
+    // Overuse detector
+    double threshold_ms_;
+    double previous_trend_;
+    double time_over_using_ms_;
+    int overuse_count_;
+    BandwidthUsage usage_;
+    double last_threshold_update_ms_;  // receiver clock, < 0 until first update
+
+    // AIMD rate control
+    RateState rate_state_;
+    int64_t delay_based_bitrate_;
+    double link_capacity_bps_;     // EMA of the acked rate at overuse, 0 = unknown
+    double link_capacity_var_;
+    Clock::time_point last_rate_update_;
+
+    // Loss-based bound
+    int64_t loss_based_bitrate_;
+    uint64_t loss_window_received_;
+    uint64_t loss_window_lost_;
+    Clock::time_point loss_window_start_;
+    bool in_loss_burst_;
+    LossCounts loss_counts_;
+
+    // Acknowledged rate over a sliding window of arrivals
+    std::deque<std::pair<int64_t, size_t>> acked_;  // (arrival us, bytes)
+    size_t acked_bytes_;
+    bool have_first_ack_;
+    int64_t first_ack_us_;
+    int64_t acked_bitrate_;
+
+    bool have_report_sequence_;
+    uint32_t next_report_sequence_;
+    Clock::time_point last_feedback_;
+    double rtt_ms_;
+    int64_t target_bitrate_;
+
+    static uint64_t key_for(uint32_t sequence_number, uint16_t packet_id) {
+        return (static_cast<uint64_t>(sequence_number) << 16) | packet_id;
+    }
+
+    void on_group_complete(const PacketGroup& group);
+    double trendline_slope() const;
+    void detect(double trend, double send_delta_ms, double arrival_ms);
+    void update_threshold(double trend, double arrival_ms);
+    void update_acked_bitrate(int64_t arrival_us, size_t size);
+    void detect_losses(uint32_t newest_sequence, bool count);
+    void update_delay_based(Clock::time_point now);
+    void update_loss_based(Clock::time_point now);
+    int64_t clamp_bitrate(int64_t bitrate) const;
+};
+
+// Receive side: collects media packet arrivals and builds feedback reports
+// at a fixed interval, or earlier when a report is full. Used from the
+// single thread that receives the packets.
+class FeedbackReporter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FeedbackReporter(size_t max_datagram_size,
+                     std::chrono::milliseconds interval = std::chrono::milliseconds(50));
+
+    // Record a media packet; returns true when a report is due
+    bool on_packet(const uint8_t* data, size_t size, Clock::time_point arrival);
+
+    // Serialize the pending arrivals into out and start a new report;
+    // returns false if nothing is pending
+    bool build_report(std::vector<uint8_t>& out);
+
+private:
+    size_t max_entries_;
+    std::chrono::milliseconds interval_;
+    FeedbackHeader report_;
+    Clock::time_point base_time_;
+    Clock::time_point last_arrival_;
+    Clock::time_point last_report_;
+    uint32_t next_report_sequence_;
+};
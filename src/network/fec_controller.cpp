@@ -0,0 +1,164 @@
+// src/network/fec_controller.cpp
+#include "fec_controller.h"
+#include "../common/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+FecController::FecController(const Config& config)
+    : config_(config), have_metrics_(false) {
+
+    if (config.min_k <= 0 || config.max_k < config.min_k || config.min_r <= 0 ||
+        config.max_r < config.min_r || config.max_k + config.max_r > 256 ||
+        config.interleave_depth <= 0) {
+        throw std::invalid_argument("Geçersiz FEC controller parametreleri");
+    }
+
+    recompute();
+}
+
+void FecController::update_path_metrics(const std::string& ip, uint16_t port,
+                                        double loss_rate, double mean_burst_length) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    loss_rate = std::min(std::max(loss_rate, 0.0), 1.0);
+    mean_burst_length = std::max(mean_burst_length, 1.0);
+
+    auto it = std::find_if(paths_.begin(), paths_.end(),
+                           [&](const PathLoss& path) {
+                               return path.ip == ip && path.port == port;
+                           });
+    if (it == paths_.end()) {
+        paths_.push_back({ip, port, loss_rate, mean_burst_length});
+    } else {
+        // React to rising loss at once, back off slowly
+        it->loss_rate = std::max(loss_rate, 0.7 * it->loss_rate + 0.3 * loss_rate);
+        it->burst_length = std::max(mean_burst_length, 0.7 * it->burst_length + 0.3 * mean_burst_length);
+    }
+
+    have_metrics_ = true;
+
+    Decision previous = decisions_[0];
+    recompute();
+    if (decisions_[0] != previous) {
+        LOG_INFO("FEC parametreleri güncellendi: k=" + std::to_string(decisions_[0].k) +
+                 " r=" + std::to_string(decisions_[0].r) +
+                 " (kayıp: " + std::to_string(get_loss_rate_locked()) + ")");
+    }
+}
+
+FecController::Decision FecController::get_params(bool keyframe, size_t data_symbols) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto& table = keyframe ? keyframe_decisions_ : decisions_;
+    size_t index = data_symbols < table.size() ? data_symbols : 0;
+    return table[index];
+}
+
+double FecController::get_loss_rate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return get_loss_rate_locked();
+}
+
+double FecController::get_burst_length() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return get_burst_length_locked();
+}
+
+double FecController::get_loss_rate_locked() const {
+    double loss_rate = 0.0;
+    for (const auto& path : paths_) {
+        loss_rate = std::max(loss_rate, path.loss_rate);
+    }
+    return loss_rate;
+}
+
+double FecController::get_burst_length_locked() const {
+    double burst_length = 1.0;
+    for (const auto& path : paths_) {
+        burst_length = std::max(burst_length, path.burst_length);
+    }
+    return burst_length;
+}
+
+double FecController::block_failure_probability(int k, int r, double loss_rate,
+                                                double burst_length) {
+    if (loss_rate <= 0.0) {
+        return 0.0;
+    }
+    if (loss_rate >= 1.0) {
+        return 1.0;
+    }
+
+    // Loss events arrive independently; each one erases `per_event` symbols
+    burst_length = std::max(burst_length, 1.0);
+    double event_rate = std::min(loss_rate / burst_length, 1.0);
+    int per_event = static_cast<int>(std::ceil(burst_length - 1e-9));
+    int tolerated = r / per_event;
+    int n = k + r;
+
+    // P(events <= tolerated) with a binomial pmf built term by term
+    double pmf = std::pow(1.0 - event_rate, n);
+    double survive = pmf;
+    for (int i = 1; i <= tolerated && i <= n; ++i) {
+        pmf *= static_cast<double>(n - i + 1) / i * event_rate / (1.0 - event_rate);
+        survive += pmf;
+    }
+
+    return std::min(std::max(1.0 - survive, 0.0), 1.0);
+}
+
+FecController::Decision FecController::choose(int max_k, int min_r, double target,
+                                              double loss_rate, double burst_length) const {
+    // Interleaving spreads one burst over depth blocks
+    double block_burst = std::max(1.0, burst_length / config_.interleave_depth);
+
+    // If no pair meets the target, the shortest block with the most parity
+    // fails least often
+    Decision best(std::min(config_.min_k, max_k), config_.max_r);
+    double best_overhead = 0.0;
+    bool found = false;
+
+    for (int k = std::min(config_.min_k, max_k); k <= max_k; ++k) {
+        for (int r = min_r; r <= config_.max_r; ++r) {
+            if (block_failure_probability(k, r, loss_rate, block_burst) > target) {
+                continue;
+            }
+            double overhead = static_cast<double>(r) / k;
+            if (!found || overhead < best_overhead) {
+                best = Decision(k, r);
+                best_overhead = overhead;
+                found = true;
+            }
+            break;
+        }
+    }
+
+    return best;
+}
+
+void FecController::recompute() {
+    decisions_.assign(config_.max_k + 1, Decision());
+    keyframe_decisions_.assign(config_.max_k + 1, Decision());
+
+    if (!have_metrics_) {
+        Decision fallback(config_.default_k, config_.default_r);
+        std::fill(decisions_.begin(), decisions_.end(), fallback);
+        Decision keyframe_fallback(config_.default_k, std::max(config_.default_r, config_.keyframe_min_r));
+        std::fill(keyframe_decisions_.begin(), keyframe_decisions_.end(), keyframe_fallback);
+        return;
+    }
+
+    double loss_rate = get_loss_rate_locked();
+    double burst_length = get_burst_length_locked();
+    int keyframe_min_r = std::max(config_.min_r, config_.keyframe_min_r);
+
+    for (int cap = 0; cap <= config_.max_k; ++cap) {
+        int max_k = cap == 0 ? config_.max_k : cap;
+        decisions_[cap] = choose(max_k, config_.min_r, config_.target_failure,
+                                 loss_rate, burst_length);
+        keyframe_decisions_[cap] = choose(max_k, std::min(keyframe_min_r, config_.max_r),
+                                          config_.keyframe_target_failure,
+                                          loss_rate, burst_length);
+    }
+}
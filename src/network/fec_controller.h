@@ -0,0 +1,84 @@
+// src/network/fec_controller.h
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+// Chooses FEC block parameters (k data, r parity symbols) from path loss
+// statistics. Losses are modelled as bursts: with loss rate p and mean burst
+// length B a block sees loss events at rate p / B per symbol, each erasing
+// about B symbols (B / depth when blocks are interleaved). For each k the
+// smallest r that keeps the block failure probability under the target is
+// taken, and the (k, r) pair with the lowest overhead wins. Keyframes get a
+// stricter target since every frame up to the next keyframe depends on them.
+class FecController {
+public:
+    struct Config {
+        int min_k;
+        int max_k;
+        int min_r;
+        int max_r;
+        int keyframe_min_r;
+        double target_failure;           // block failure probability for P-frames
+        double keyframe_target_failure;  // block failure probability for keyframes
+        int interleave_depth;
+        int default_k;                   // used until the first loss report
+        int default_r;
+
+        Config() : min_k(4), max_k(16), min_r(1), max_r(8), keyframe_min_r(2),
+                   target_failure(1e-3), keyframe_target_failure(1e-5),
+                   interleave_depth(1), default_k(8), default_r(2) {}
+    };
+
+    struct Decision {
+        int k;
+        int r;
+
+        Decision() : k(0), r(0) {}
+        Decision(int k_val, int r_val) : k(k_val), r(r_val) {}
+        bool operator==(const Decision& other) const { return k == other.k && r == other.r; }
+        bool operator!=(const Decision& other) const { return !(*this == other); }
+    };
+
+    explicit FecController(const Config& config = Config());
+
+    // Update loss statistics of a path; the worst path drives the decision
+    void update_path_metrics(const std::string& ip, uint16_t port,
+                             double loss_rate, double mean_burst_length);
+
+    // Parameters for the next frame. data_symbols caps k to the frame's chunk
+    // count in per-frame mode so small frames are not charged for phantom
+    // symbols; 0 means no cap.
+    Decision get_params(bool keyframe, size_t data_symbols = 0) const;
+
+    // Smoothed loss estimate used for the current decisions
+    double get_loss_rate() const;
+    double get_burst_length() const;
+
+    // Probability that more than r of n = k + r symbols are lost
+    static double block_failure_probability(int k, int r, double loss_rate,
+                                            double burst_length);
+
+private:
+    struct PathLoss {
+        std::string ip;
+        uint16_t port;
+        double loss_rate;
+        double burst_length;
+    };
+
+    Config config_;
+    mutable std::mutex mutex_;
+    std::vector<PathLoss> paths_;
+    bool have_metrics_;
+
+    // Decisions indexed by capped k (index 0 = uncapped)
+    std::vector<Decision> decisions_;
+    std::vector<Decision> keyframe_decisions_;
+
+    void recompute();
+    double get_loss_rate_locked() const;
+    double get_burst_length_locked() const;
+    Decision choose(int max_k, int min_r, double target, double loss_rate, double burst_length) const;
+};
@@ -0,0 +1,60 @@
+// src/network/pacer.h
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "../common/byte_span.h"
+
+// Token bucket in front of a path's batched sends. Budget accrues at the
+// pacing rate and is capped at burst_bytes, so a keyframe leaves as a
+// series of short bursts instead of one line-rate train that overflows
+// shallow router queues. A send waits until a full burst (or the rest of
+// its batch) is covered, then takes every datagram the budget allows;
+// sendmmsg and GSO batching keep working within each burst.
+//
+// Waits are absolute CLOCK_MONOTONIC deadlines slept with clock_nanosleep,
+// which wakes within tens of microseconds and never drifts across waits.
+// acquire() is meant for a single sending thread; set_rate() may be called
+// from anywhere.
+class Pacer {
+public:
+    struct Config {
+        int64_t rate_bps;      // initial pacing rate
+        int64_t min_rate_bps;  // floor for set_rate
+        size_t burst_bytes;    // budget that may go out back to back
+
+        Config() : rate_bps(7500000), min_rate_bps(100000), burst_bytes(6000) {}
+    };
+
+    explicit Pacer(const Config& config = Config());
+
+    // Change the pacing rate; clamped to min_rate_bps
+    void set_rate(int64_t rate_bps);
+    int64_t get_rate() const { return rate_bps_.load(std::memory_order_relaxed); }
+
+    // Block until a burst may be sent, then charge the budget for the
+    // longest run of chunks that fits and return its length (0 only if
+    // count is 0). A datagram larger than the burst budget waits for a full
+    // bucket and goes out on its own.
+    size_t acquire(const ConstByteSpan* chunks, size_t count);
+
+    // Non-blocking acquire for a thread pacing several paths: returns 0 and
+    // sets ready_at_ns to when the burst will fit if it does not yet
+    size_t try_acquire(const ConstByteSpan* chunks, size_t count, int64_t& ready_at_ns);
+
+    // Total time spent waiting in acquire
+    uint64_t get_wait_ns() const { return wait_ns_; }
+
+    // Clock of ready_at_ns (CLOCK_MONOTONIC), and an absolute sleep on it
+    static int64_t now_ns();
+    static void sleep_until(int64_t deadline_ns);
+
+private:
+    Config config_;
+    std::atomic<int64_t> rate_bps_;
+    double budget_bytes_;
+    int64_t last_refill_ns_;
+    uint64_t wait_ns_;
+
+    void refill(int64_t now_ns);
+};
@@ -66,11 +66,31 @@ void PathMonitor::increment_packets_sent() {
 void PathMonitor::increment_packets_received() {
     std::lock_guard<std::mutex> lock(metrics_mutex_);
     metrics_.packets_received++;
+    interval_received_++;
+    in_loss_burst_ = false;
 }
 
 void PathMonitor::increment_packets_lost() {
     std::lock_guard<std::mutex> lock(metrics_mutex_);
     metrics_.packets_lost++;
+    interval_lost_++;
+    
+    // Losses reported back to back belong to the same burst
+    if (!in_loss_burst_) {
+        metrics_.loss_bursts++;
+        interval_bursts_++;
+        in_loss_burst_ = true;
+    }
+}
+
+void PathMonitor::add_packet_counts(uint64_t received, uint64_t lost, uint64_t loss_bursts) {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    metrics_.packets_received += received;
+    metrics_.packets_lost += lost;
+    metrics_.loss_bursts += loss_bursts;
+    interval_received_ += received;
+    interval_lost_ += lost;
+    interval_bursts_ += loss_bursts;
 }
 
 PathMetrics PathMonitor::get_metrics() const {
@@ -102,28 +122,30 @@ void PathMonitor::monitor_loop() {
 void PathMonitor::calculate_metrics() {
     std::lock_guard<std::mutex> lock(metrics_mutex_);
     
-    // Calculate loss rate
-    uint64_t total_packets = metrics_.packets_sent + metrics_.packets_received;
+    // Loss over the packets whose fate became known this interval; the FEC
+    // controller smooths across intervals. An interval without reports
+    // keeps the last estimate.
+    uint64_t total_packets = interval_received_ + interval_lost_;
     if (total_packets > 0) {
-        metrics_.loss_rate = static_cast<double>(metrics_.packets_lost) / total_packets;
-    } else {
-        metrics_.loss_rate = 0.0;
+        metrics_.loss_rate = static_cast<double>(interval_lost_) / total_packets;
     }
     
-    // Apply exponential moving average for RTT
-    // This is a simplified calculation - in a real implementation,
-    // you would maintain a window of RTT measurements
-    if (metrics_.rtt_ms > 0) {
-        // Simple smoothing: new_rtt = 0.9 * old_rtt + 0.1 * new_measurement
-        // This is just an example - actual implementation would be more sophisticated
+    // Mean burst length drives how much parity a burst-tolerant FEC needs;
+    // it describes the loss process, so clean intervals leave it as it is
+    if (interval_bursts_ > 0) {
+        metrics_.mean_burst_length = static_cast<double>(interval_lost_) / interval_bursts_;
     }
     
-    // Calculate bandwidth (simplified)
-    // In a real implementation, you would measure bytes transferred over time
+    interval_received_ = 0;
+    interval_lost_ = 0;
+    interval_bursts_ = 0;
+    
+    // RTT arrives already smoothed from the congestion controller
+    
+    // Bandwidth is the congestion controller's estimate (update_bandwidth);
+    // until the first feedback arrives assume a typical uplink
     if (metrics_.bandwidth_mbps <= 0) {
-        // Estimate based on packet rate and size
-        // This is a placeholder calculation
-        metrics_.bandwidth_mbps = 10.0; // Default estimate
+        metrics_.bandwidth_mbps = 10.0;
     }
 }
 
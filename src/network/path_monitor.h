@@ -10,14 +10,17 @@
 
 struct PathMetrics {
     double rtt_ms;
-    double loss_rate;
+    double loss_rate;           // over the last update interval
     double bandwidth_mbps;
     uint64_t packets_sent;
     uint64_t packets_received;
     uint64_t packets_lost;
+    uint64_t loss_bursts;       // runs of consecutive lost packets
+    double mean_burst_length;   // lost / bursts over the last interval that had losses
     
     PathMetrics() : rtt_ms(0.0), loss_rate(0.0), bandwidth_mbps(0.0),
-                    packets_sent(0), packets_received(0), packets_lost(0) {}
+                    packets_sent(0), packets_received(0), packets_lost(0),
+                    loss_bursts(0), mean_burst_length(1.0) {}
 };
 
 class PathMonitor {
@@ -44,6 +47,9 @@ public:
     void increment_packets_received();
     void increment_packets_lost();
     
+    // Add packet fates learnt from receiver feedback in one step
+    void add_packet_counts(uint64_t received, uint64_t lost, uint64_t loss_bursts);
+    
     // Get current metrics
     PathMetrics get_metrics() const;
     
@@ -62,6 +68,13 @@ private:
     mutable std::mutex metrics_mutex_;
     PathMetrics metrics_;
     MetricsCallback metrics_callback_;
+    bool in_loss_burst_{false};
+    
+    // Packet fates since the last calculate_metrics(); the lifetime totals
+    // in metrics_ would hide a new loss episode after a long clean run
+    uint64_t interval_received_{0};
+    uint64_t interval_lost_{0};
+    uint64_t interval_bursts_{0};
     
     // Monitoring parameters
     std::chrono::milliseconds update_interval_{1000}; // 1 second
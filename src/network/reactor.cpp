@@ -0,0 +1,199 @@
+// src/network/reactor.cpp
+#include "reactor.h"
+#include "../common/logger.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+Reactor::Reactor() : epoll_fd_(-1), wake_fd_(-1) {
+}
+
+Reactor::~Reactor() {
+    stop();
+    for (int fd : timer_fds_) {
+        close(fd);
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+}
+
+bool Reactor::initialize() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        LOG_ERROR("epoll oluşturulamadı: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        LOG_ERROR("eventfd oluşturulamadı: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    struct epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) < 0) {
+        LOG_ERROR("eventfd epoll'a eklenemedi: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    return true;
+}
+
+bool Reactor::add(int fd, ReadHandler handler) {
+    if (epoll_fd_ < 0 || fd < 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+
+    struct epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    int op = handlers_.count(fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (epoll_ctl(epoll_fd_, op, fd, &event) < 0) {
+        LOG_ERROR("Socket epoll'a eklenemedi: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    handlers_[fd] = std::make_shared<ReadHandler>(std::move(handler));
+    return true;
+}
+
+bool Reactor::add_timer(std::chrono::milliseconds interval, ReadHandler handler) {
+    if (interval.count() <= 0) {
+        return false;
+    }
+
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("timerfd oluşturulamadı: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    struct itimerspec spec{};
+    spec.it_interval.tv_sec = interval.count() / 1000;
+    spec.it_interval.tv_nsec = (interval.count() % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+        LOG_ERROR("timerfd kurulamadı: " + std::string(strerror(errno)));
+        close(fd);
+        return false;
+    }
+
+    // Expirations missed while a handler ran are folded into one call
+    bool added = add(fd, [fd, handler = std::move(handler)] {
+        uint64_t expirations;
+        if (read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+            handler();
+        }
+    });
+    if (!added) {
+        close(fd);
+        return false;
+    }
+    timer_fds_.push_back(fd);
+    return true;
+}
+
+void Reactor::remove(int fd) {
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+
+    if (handlers_.erase(fd) && epoll_fd_ >= 0) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+void Reactor::start() {
+    if (running_.load()) {
+        LOG_WARNING("Reactor zaten çalışıyor");
+        return;
+    }
+
+    if (epoll_fd_ < 0) {
+        LOG_ERROR("Reactor başlatılmadan önce initialize edilmeli");
+        return;
+    }
+
+    running_ = true;
+    reactor_thread_ = std::thread(&Reactor::reactor_loop, this);
+
+    LOG_INFO("Reactor başlatıldı");
+}
+
+void Reactor::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    running_ = false;
+    wake();
+
+    if (reactor_thread_.joinable()) {
+        reactor_thread_.join();
+    }
+
+    LOG_INFO("Reactor durduruldu");
+}
+
+void Reactor::wake() {
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written;
+}
+
+void Reactor::reactor_loop() {
+    const int max_events = 16;
+    struct epoll_event events[max_events];
+
+    while (running_.load()) {
+        int count = epoll_wait(epoll_fd_, events, max_events, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Anything else (EBADF, EINVAL) will fail the same way on every
+            // retry; stop() still joins the thread
+            LOG_ERROR("epoll_wait hatası, reactor durdu: " + std::string(strerror(errno)));
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == wake_fd_) {
+                uint64_t value;
+                ssize_t bytes_read = read(wake_fd_, &value, sizeof(value));
+                (void)bytes_read;
+                continue;
+            }
+
+            // Take a reference so the handler may remove itself
+            std::shared_ptr<ReadHandler> handler;
+            {
+                std::lock_guard<std::mutex> lock(handlers_mutex_);
+                auto it = handlers_.find(fd);
+                if (it != handlers_.end()) {
+                    handler = it->second;
+                }
+            }
+
+            if (handler) {
+                try {
+                    (*handler)();
+                } catch (const std::exception& e) {
+                    LOG_ERROR("Reactor handler hatası: " + std::string(e.what()));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,51 @@
+// src/network/reactor.h
+#pragma once
+#include <functional>
+#include <memory>
+#include <map>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+
+// Single-threaded epoll reactor. Registered file descriptors are watched for
+// readability and their handler runs on the reactor thread as soon as data
+// arrives; the thread sleeps in epoll_wait while idle. Handlers must drain
+// their descriptor (level triggered) and must not block.
+class Reactor {
+public:
+    using ReadHandler = std::function<void()>;
+
+    Reactor();
+    ~Reactor();
+
+    // Create the epoll instance and wakeup eventfd
+    bool initialize();
+
+    // Watch fd for readability; replaces an existing handler
+    bool add(int fd, ReadHandler handler);
+    void remove(int fd);
+
+    // Run handler on the reactor thread every interval (a timerfd), for
+    // work that must happen even when no packet arrives
+    bool add_timer(std::chrono::milliseconds interval, ReadHandler handler);
+
+    // Start/stop reactor thread
+    void start();
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+
+private:
+    int epoll_fd_;
+    int wake_fd_;
+    std::atomic<bool> running_{false};
+    std::thread reactor_thread_;
+    std::mutex handlers_mutex_;
+    std::map<int, std::shared_ptr<ReadHandler>> handlers_;
+    std::vector<int> timer_fds_;
+
+    void reactor_loop();
+    void wake();
+};
@@ -0,0 +1,110 @@
+// src/network/retransmit_cache.cpp
+#include "retransmit_cache.h"
+#include <algorithm>
+#include <stdexcept>
+
+RetransmitCache::RetransmitCache(const Config& config)
+    : config_(config), entries_(config.capacity), next_entry_(0), rate_bps_(config.rate_bps),
+      budget_bytes_(static_cast<double>(config.burst_bytes)), last_refill_(Clock::now()),
+      resent_(0), rate_limited_(0) {
+
+    if (config.capacity == 0 || config.rate_bps <= 0 || config.burst_bytes == 0) {
+        throw std::invalid_argument("Geçersiz retransmit cache parametreleri");
+    }
+}
+
+void RetransmitCache::store(const ConstByteSpan* datagrams, size_t count, Clock::time_point send_time) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < count; ++i) {
+        DataHeader header;
+        if (!DataHeader::parse(datagrams[i].data, datagrams[i].size, header) || header.is_retransmission()) {
+            continue;
+        }
+
+        Entry& entry = entries_[next_entry_];
+        if (entry.valid) {
+            auto it = index_.find(entry.key);
+            if (it != index_.end() && it->second == next_entry_) {
+                index_.erase(it);
+            }
+        }
+        entry.valid = true;
+        entry.key = key_for(header.sequence_number, header.chunk_id);
+        entry.send_time = send_time;
+        entry.last_resend = Clock::time_point();
+        entry.data.assign(datagrams[i].begin(), datagrams[i].end());
+        index_[entry.key] = next_entry_;
+
+        next_entry_ = (next_entry_ + 1) % entries_.size();
+    }
+}
+
+void RetransmitCache::set_rate(int64_t rate_bps) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rate_bps_ = std::max<int64_t>(rate_bps, 1);
+}
+
+size_t RetransmitCache::fetch(const NackHeader& nack, Clock::time_point now,
+                              std::vector<std::vector<uint8_t>>& datagrams) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    double elapsed_s = std::chrono::duration<double>(now - last_refill_).count();
+    last_refill_ = now;
+    budget_bytes_ = std::min(budget_bytes_ + std::max(elapsed_s, 0.0) * rate_bps_ / 8.0,
+                             static_cast<double>(config_.burst_bytes));
+
+    size_t filled = 0;
+    for (const auto& request : nack.entries) {
+        if (request.chunk_id == NackHeader::kWholeFrame) {
+            auto it = index_.lower_bound(key_for(request.sequence_number, 0));
+            auto end = index_.lower_bound(key_for(request.sequence_number, NackHeader::kWholeFrame));
+            for (; it != end; ++it) {
+                if (!resend(entries_[it->second], now, datagrams, filled)) {
+                    return filled;
+                }
+            }
+            continue;
+        }
+
+        auto it = index_.find(key_for(request.sequence_number, request.chunk_id));
+        if (it != index_.end() && !resend(entries_[it->second], now, datagrams, filled)) {
+            return filled;
+        }
+    }
+    return filled;
+}
+
+bool RetransmitCache::resend(Entry& entry, Clock::time_point now,
+                             std::vector<std::vector<uint8_t>>& datagrams, size_t& filled) {
+    if (now - entry.send_time > std::chrono::milliseconds(config_.max_age_ms) ||
+        now - entry.last_resend < std::chrono::milliseconds(config_.min_interval_ms)) {
+        return true;
+    }
+
+    // Out of budget: the rest of the NACK is dropped, the receiver asks again
+    if (budget_bytes_ < static_cast<double>(entry.data.size())) {
+        rate_limited_++;
+        return false;
+    }
+    budget_bytes_ -= static_cast<double>(entry.data.size());
+    entry.last_resend = now;
+    resent_++;
+
+    if (datagrams.size() <= filled) {
+        datagrams.resize(filled + 1);
+    }
+    std::vector<uint8_t>& datagram = datagrams[filled++];
+    datagram.assign(entry.data.begin(), entry.data.end());
+    datagram[DataHeader::kFlagsOffset] |= DataHeader::kFlagRetransmission;
+    return true;
+}
+
+uint64_t RetransmitCache::get_resent_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resent_;
+}
+
+uint64_t RetransmitCache::get_rate_limited_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rate_limited_;
+}
@@ -0,0 +1,83 @@
+// src/network/retransmit_cache.h
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "../common/byte_span.h"
+#include "../transport/packet_header.h"
+
+// Copies of the data datagrams sent last, for resending what a receiver
+// NACKs. A fixed ring of capacity entries keeps its buffers once warmed up;
+// the oldest entry is overwritten by the next datagram.
+//
+// A chunk is resent only while it is younger than max_age_ms (later it
+// would miss the receiver's playout), at most once per min_interval_ms
+// (a NACK repeated before the resend could arrive), and within a token
+// bucket of rate_bps so a burst of NACKs after an outage cannot starve
+// the media. store() and fetch() may be called from different threads.
+class RetransmitCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        size_t capacity;           // datagrams kept
+        uint32_t max_age_ms;
+        uint32_t min_interval_ms;
+        int64_t rate_bps;          // initial resend rate cap
+        size_t burst_bytes;        // resend budget that may go out at once
+
+        Config() : capacity(2048), max_age_ms(100), min_interval_ms(10), rate_bps(750000),
+                   burst_bytes(64 * 1024) {}
+    };
+
+    explicit RetransmitCache(const Config& config = Config());
+
+    // Keep the data chunks among datagrams, sent at send_time
+    void store(const ConstByteSpan* datagrams, size_t count, Clock::time_point send_time);
+
+    // Change the resend rate cap
+    void set_rate(int64_t rate_bps);
+
+    // Copy the chunks a NACK asks for into datagrams, flagged as
+    // retransmissions; returns how many were filled (the rest of the
+    // vector is left as is so its buffers are reused)
+    size_t fetch(const NackHeader& nack, Clock::time_point now, std::vector<std::vector<uint8_t>>& datagrams);
+
+    // Get statistics
+    uint64_t get_resent_count() const;
+    uint64_t get_rate_limited_count() const;
+
+private:
+    struct Entry {
+        bool valid;
+        uint64_t key;
+        Clock::time_point send_time;
+        Clock::time_point last_resend;
+        std::vector<uint8_t> data;
+
+        Entry() : valid(false), key(0) {}
+    };
+
+    Config config_;
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+    size_t next_entry_;
+    std::map<uint64_t, size_t> index_;  // (sequence_number << 16 | chunk_id) -> entry
+
+    int64_t rate_bps_;
+    double budget_bytes_;
+    Clock::time_point last_refill_;
+
+    uint64_t resent_;
+    uint64_t rate_limited_;
+
+    static uint64_t key_for(uint32_t sequence_number, uint16_t chunk_id) {
+        return (static_cast<uint64_t>(sequence_number) << 16) | chunk_id;
+    }
+
+    bool resend(Entry& entry, Clock::time_point now, std::vector<std::vector<uint8_t>>& datagrams,
+                size_t& filled);
+};
@@ -86,6 +86,54 @@ PathInfo* Scheduler::get_next_path(Strategy strategy) {
     }
 }
 
+bool Scheduler::stripe(size_t count, std::vector<size_t>& path_indices) {
+    std::lock_guard<std::mutex> lock(paths_mutex_);
+    path_indices.clear();
+    
+    double min_rtt_ms = std::numeric_limits<double>::max();
+    for (const auto& path : paths_) {
+        if (path.is_active && path.rtt_ms > 0.0) {
+            min_rtt_ms = std::min(min_rtt_ms, path.rtt_ms);
+        }
+    }
+    
+    std::vector<size_t> active_paths;
+    std::vector<double> weights;
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        if (paths_[i].is_active) {
+            active_paths.push_back(i);
+            weights.push_back(calculate_stripe_weight(paths_[i], min_rtt_ms));
+        } else {
+            paths_[i].stripe_credit = 0.0;
+        }
+    }
+    if (active_paths.empty()) {
+        return false;
+    }
+    normalize_weights(weights);
+    
+    // Smooth weighted round robin: each pick credits every path with its
+    // weight and takes the one with the most credit, which pays one pick.
+    // Consecutive datagrams alternate between paths, so data and parity of
+    // every FEC block are spread over all of them and a path that stalls
+    // costs a block only its share. Credit carries over between frames.
+    path_indices.reserve(count);
+    for (size_t n = 0; n < count; ++n) {
+        size_t best = 0;
+        for (size_t j = 0; j < active_paths.size(); ++j) {
+            PathInfo& path = paths_[active_paths[j]];
+            path.stripe_credit += weights[j];
+            if (path.stripe_credit > paths_[active_paths[best]].stripe_credit) {
+                best = j;
+            }
+        }
+        paths_[active_paths[best]].stripe_credit -= 1.0;
+        path_indices.push_back(active_paths[best]);
+    }
+    
+    return true;
+}
+
 PathInfo* Scheduler::round_robin_select() {
     if (paths_.empty()) return nullptr;
     
@@ -181,6 +229,19 @@ double Scheduler::calculate_path_weight(const PathInfo& path) const {
     return rtt_weight * loss_weight * (1.0 + bandwidth_weight);
 }
 
+double Scheduler::calculate_stripe_weight(const PathInfo& path, double min_rtt_ms) const {
+    // Share follows capacity; a path without an estimate counts as 1 Mbps
+    double weight = path.bandwidth_mbps > 0.0 ? path.bandwidth_mbps : 1.0;
+    weight *= 1.0 - std::min(path.loss_rate, 0.9);
+    
+    // Packets on a slower path hold up the frame they belong to, so it
+    // carries less than its capacity alone would suggest
+    if (path.rtt_ms > 0.0 && path.rtt_ms > min_rtt_ms) {
+        weight *= min_rtt_ms / path.rtt_ms;
+    }
+    return weight;
+}
+
 void Scheduler::normalize_weights(std::vector<double>& weights) const {
     if (weights.empty()) return;
     
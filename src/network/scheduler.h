@@ -18,10 +18,11 @@ struct PathInfo {
     double loss_rate;
     double bandwidth_mbps;
     bool is_active;
+    double stripe_credit;  // smooth weighted round robin state
     
     PathInfo(const std::string& ip_addr, uint16_t port_num)
         : ip(ip_addr), port(port_num), rtt_ms(0.0), 
-          loss_rate(0.0), bandwidth_mbps(0.0), is_active(true) {}
+          loss_rate(0.0), bandwidth_mbps(0.0), is_active(true), stripe_credit(0.0) {}
 };
 
 class Scheduler {
@@ -50,6 +51,12 @@ public:
     // Get next path based on strategy
     PathInfo* get_next_path(Strategy strategy = ADAPTIVE);
     
+    // Assign count consecutive datagrams to the active paths in proportion
+    // to their capacity, discounted by loss and RTT. Entries of
+    // path_indices index the paths in the order they were added. Returns
+    // false if no path is active.
+    bool stripe(size_t count, std::vector<size_t>& path_indices);
+    
     // Set scheduling strategy
     void set_strategy(Strategy strategy) { current_strategy_ = strategy; }
     
@@ -80,5 +87,6 @@ private:
     
     // Helper functions
     double calculate_path_weight(const PathInfo& path) const;
+    double calculate_stripe_weight(const PathInfo& path, double min_rtt_ms) const;
     void normalize_weights(std::vector<double>& weights) const;
 };
\ No newline at end of file
@@ -3,14 +3,35 @@
 #include "../common/logger.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <cstring>
+#include <algorithm>
 #include <stdexcept>
 
-SenderReceiver::SenderReceiver(const std::string& remote_ip, uint16_t remote_port)
-    : remote_ip_(remote_ip), remote_port_(remote_port), sockfd_(-1), running_(false) {
+// Older libc headers lack the segmentation offload options
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+SenderReceiver::SenderReceiver(const std::string& remote_ip, uint16_t remote_port,
+                               size_t max_datagram_size)
+    : remote_ip_(remote_ip), remote_port_(remote_port), sockfd_(-1),
+      max_datagram_size_(max_datagram_size), gro_enabled_(false),
+      running_(false) {
+    
+    if (max_datagram_size == 0 || max_datagram_size > 65536) {
+        throw std::invalid_argument("Geçersiz datagram boyutu");
+    }
 }
 
 SenderReceiver::~SenderReceiver() {
@@ -68,6 +89,14 @@ bool SenderReceiver::initialize() {
             return false;
         }
         
+        // Preallocate the mmsghdr/iovec rings; only the lengths change per call
+        send_msgs_.assign(kBatchSize, mmsghdr{});
+        send_iovecs_.assign(kBatchSize * kMaxGsoSegments, iovec{});
+        send_control_.assign(kBatchSize * CMSG_SPACE(sizeof(uint16_t)), 0);
+        send_counts_.assign(kBatchSize, 0);
+        
+        allocate_receive_ring(max_datagram_size_, kBatchSize);
+        
         // Get local port
         socklen_t addr_len = sizeof(local_addr);
         if (getsockname(sockfd_, (struct sockaddr*)&local_addr, &addr_len) < 0) {
@@ -87,14 +116,16 @@ bool SenderReceiver::initialize() {
     }
 }
 
-void SenderReceiver::start() {
+void SenderReceiver::start(bool own_receive_thread) {
     if (running_.load()) {
         LOG_WARNING("SenderReceiver zaten çalışıyor");
         return;
     }
     
     running_ = true;
-    receive_thread_ = std::thread(&SenderReceiver::receive_loop, this);
+    if (own_receive_thread) {
+        receive_thread_ = std::thread(&SenderReceiver::receive_loop, this);
+    }
     
     LOG_INFO("SenderReceiver başlatıldı");
 }
@@ -110,68 +141,392 @@ void SenderReceiver::stop() {
         receive_thread_.join();
     }
     
+    // Hand armed buffers back to their pool
+    {
+        std::lock_guard<std::mutex> lock(receive_mutex_);
+        receive_packets_.clear();
+    }
+    
     LOG_INFO("SenderReceiver durduruldu");
 }
 
-void SenderReceiver::send_chunk(const std::vector<uint8_t>& chunk_data) {
-    if (sockfd_ < 0 || !running_.load()) {
+void SenderReceiver::send_chunk(ConstByteSpan chunk_data) {
+    send_chunks(&chunk_data, 1);
+}
+
+bool SenderReceiver::enable_segmentation_offload() {
+    if (sockfd_ < 0) {
+        return false;
+    }
+    
+    // A zero socket-wide segment size is accepted exactly when the kernel
+    // knows UDP_SEGMENT; the real size travels per message as a cmsg
+    int zero = 0;
+    gso_enabled_ = setsockopt(sockfd_, SOL_UDP, UDP_SEGMENT, &zero, sizeof(zero)) == 0;
+    
+    int one = 1;
+    if (setsockopt(sockfd_, SOL_UDP, UDP_GRO, &one, sizeof(one)) == 0) {
+        std::lock_guard<std::mutex> lock(receive_mutex_);
+        gro_enabled_ = true;
+        allocate_receive_ring(kGroSlotSize, kGroBatchSize);
+    }
+    
+    LOG_INFO(std::string("UDP segmentation offload: GSO ") + (gso_enabled_.load() ? "açık" : "yok") +
+             ", GRO " + (gro_enabled_ ? "açık" : "yok"));
+    
+    return gso_enabled_.load() || gro_enabled_;
+}
+
+void SenderReceiver::disable_gro() {
+    std::lock_guard<std::mutex> lock(receive_mutex_);
+    if (!gro_enabled_) {
+        return;
+    }
+    int zero = 0;
+    if (setsockopt(sockfd_, SOL_UDP, UDP_GRO, &zero, sizeof(zero)) < 0) {
+        LOG_WARNING("UDP GRO kapatılamadı: " + std::string(strerror(errno)));
         return;
     }
+    gro_enabled_ = false;
+    allocate_receive_ring(max_datagram_size_, kBatchSize);
+}
+
+void SenderReceiver::allocate_receive_ring(size_t slot_size, size_t slots) {
+    receive_buffer_.assign(slots * slot_size, 0);
+    receive_msgs_.assign(slots, mmsghdr{});
+    receive_iovecs_.assign(slots, iovec{});
+    receive_addrs_.assign(slots, sockaddr_in{});
+    receive_control_.assign(slots * CMSG_SPACE(sizeof(int)), 0);
+    for (size_t i = 0; i < slots; ++i) {
+        receive_iovecs_[i].iov_base = receive_buffer_.data() + i * slot_size;
+        receive_iovecs_[i].iov_len = slot_size;
+        msghdr& hdr = receive_msgs_[i].msg_hdr;
+        hdr.msg_iov = &receive_iovecs_[i];
+        hdr.msg_iovlen = 1;
+    }
+}
+
+size_t SenderReceiver::build_send_batch(const ConstByteSpan* chunks, size_t count, bool use_gso) {
+    const size_t control_space = CMSG_SPACE(sizeof(uint16_t));
+    size_t messages = 0;
+    size_t iov_used = 0;
+    size_t next = 0;
+    
+    while (next < count && messages < kBatchSize) {
+        // A GSO run: equal-size datagrams, the last one may be shorter
+        size_t segment = chunks[next].size;
+        size_t run = 1;
+        size_t bytes = segment;
+        if (use_gso) {
+            while (next + run < count && run < kMaxGsoSegments &&
+                   bytes + chunks[next + run].size <= kMaxGsoBytes &&
+                   chunks[next + run].size <= segment) {
+                bytes += chunks[next + run].size;
+                run++;
+                if (chunks[next + run - 1].size < segment) {
+                    break;
+                }
+            }
+        }
+        
+        mmsghdr& msg = send_msgs_[messages];
+        msg = mmsghdr{};
+        msghdr& hdr = msg.msg_hdr;
+        hdr.msg_name = &remote_addr_;
+        hdr.msg_namelen = sizeof(remote_addr_);
+        hdr.msg_iov = &send_iovecs_[iov_used];
+        hdr.msg_iovlen = run;
+        
+        for (size_t i = 0; i < run; ++i) {
+            send_iovecs_[iov_used + i].iov_base = const_cast<uint8_t*>(chunks[next + i].data);
+            send_iovecs_[iov_used + i].iov_len = chunks[next + i].size;
+        }
+        
+        if (run > 1) {
+            hdr.msg_control = send_control_.data() + messages * control_space;
+            hdr.msg_controllen = control_space;
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t gso_size = static_cast<uint16_t>(segment);
+            memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+        }
+        
+        send_counts_[messages] = run;
+        iov_used += run;
+        next += run;
+        messages++;
+    }
+    
+    return messages;
+}
+
+size_t SenderReceiver::send_chunks(const ConstByteSpan* chunks, size_t count) {
+    if (sockfd_ < 0 || !running_.load()) {
+        return 0;
+    }
+    
+    size_t sent = 0;
     
     try {
-        ssize_t bytes_sent = sendto(sockfd_, chunk_data.data(), chunk_data.size(), 0,
-                                   (const struct sockaddr*)&remote_addr_, sizeof(remote_addr_));
+        std::lock_guard<std::mutex> lock(send_mutex_);
         
-        if (bytes_sent < 0) {
-            if (errno != EWOULDBLOCK && errno != EAGAIN) {
+        size_t next = 0;
+        while (next < count) {
+            bool use_gso = gso_enabled_.load();
+            size_t messages = build_send_batch(chunks + next, count - next, use_gso);
+            
+            int result = sendmmsg(sockfd_, send_msgs_.data(), static_cast<unsigned int>(messages), 0);
+            if (result > 0) {
+                for (int i = 0; i < result; ++i) {
+                    size_t expected = 0;
+                    for (size_t j = 0; j < send_counts_[i]; ++j) {
+                        expected += chunks[next + j].size;
+                    }
+                    if (send_msgs_[i].msg_len != expected) {
+                        LOG_WARNING("Kısmi gönderim: " + std::to_string(send_msgs_[i].msg_len) + "/" +
+                                    std::to_string(expected));
+                    }
+                    next += send_counts_[i];
+                    sent += send_counts_[i];
+                }
+            } else if (errno == EWOULDBLOCK || errno == EAGAIN) {
+                // Socket buffer full: give the kernel a moment, then drop the rest
+                if (!wait_writable(5)) {
+                    break;
+                }
+            } else if (errno == EINTR) {
+                continue;
+            } else if (use_gso && (errno == EIO || errno == EINVAL)) {
+                // The route or device cannot segment (no checksum offload);
+                // fall back to one datagram per message for good
+                LOG_WARNING("UDP GSO bu yolda desteklenmiyor, sendmmsg'e dönülüyor: " +
+                            std::string(strerror(errno)));
+                gso_enabled_ = false;
+            } else {
+                // The first message of the batch failed; skip it and carry on
                 LOG_ERROR("Chunk gönderilemedi: " + std::string(strerror(errno)));
+                next += send_counts_[0];
             }
-        } else if (bytes_sent != static_cast<ssize_t>(chunk_data.size())) {
-            LOG_WARNING("Kısmi gönderim: " + std::to_string(bytes_sent) + "/" + std::to_string(chunk_data.size()));
         }
         
     } catch (const std::exception& e) {
         LOG_ERROR("Chunk gönderme hatası: " + std::string(e.what()));
     }
+    
+    return sent;
 }
 
-std::vector<std::vector<uint8_t>> SenderReceiver::receive_chunks() {
-    std::vector<std::vector<uint8_t>> received_chunks;
-    
+bool SenderReceiver::wait_writable(int timeout_ms) {
+    struct pollfd pfd{};
+    pfd.fd = sockfd_;
+    pfd.events = POLLOUT;
+    return poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLOUT);
+}
+
+size_t SenderReceiver::receive_batch(const DatagramHandler& handler) {
     if (sockfd_ < 0) {
-        return received_chunks;
+        return 0;
     }
     
-    std::vector<uint8_t> buffer(65536); // Large buffer for video chunks
+    std::lock_guard<std::mutex> lock(receive_mutex_);
+    const size_t slots = receive_msgs_.size();
+    const size_t slot_size = receive_buffer_.size() / slots;
+    size_t delivered = 0;
+    
+    // receive_packets() may have pointed the iovecs at pool buffers
+    for (size_t i = 0; i < slots; ++i) {
+        receive_iovecs_[i].iov_base = receive_buffer_.data() + i * slot_size;
+        receive_iovecs_[i].iov_len = slot_size;
+    }
     
     while (running_.load()) {
-        struct sockaddr_in src_addr{};
-        socklen_t addr_len = sizeof(src_addr);
+        prepare_receive_headers(slots);
         
-        ssize_t bytes_read = recvfrom(sockfd_, buffer.data(), buffer.size(), 0,
-                                     (struct sockaddr*)&src_addr, &addr_len);
+        int result = recvmmsg(sockfd_, receive_msgs_.data(), static_cast<unsigned int>(slots),
+                              MSG_DONTWAIT, nullptr);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EWOULDBLOCK && errno != EAGAIN) {
+                LOG_ERROR("Alma hatası: " + std::string(strerror(errno)));
+            }
+            break;
+        }
         
-        if (bytes_read > 0) {
+        for (int i = 0; i < result; ++i) {
+            msghdr& hdr = receive_msgs_[i].msg_hdr;
+            
             // Verify sender
-            if (src_addr.sin_addr.s_addr == remote_addr_.sin_addr.s_addr &&
-                src_addr.sin_port == remote_addr_.sin_port) {
-                
-                std::vector<uint8_t> chunk_data(buffer.begin(), buffer.begin() + bytes_read);
-                received_chunks.push_back(std::move(chunk_data));
+            if (!is_from_remote(receive_addrs_[i])) {
+                continue;
             }
-        } else if (bytes_read < 0) {
-            if (errno == EWOULDBLOCK || errno == EAGAIN) {
-                // No data available, break
-                break;
-            } else {
+            if (hdr.msg_flags & MSG_TRUNC) {
+                LOG_WARNING("Datagram kesildi, max datagram boyutu yetersiz");
+                continue;
+            }
+            
+            // GRO hands over several same-size datagrams back to back
+            size_t length = receive_msgs_[i].msg_len;
+            size_t segment = length;
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+                if (size_t gso_size = gro_segment_size(cmsg)) {
+                    segment = gso_size;
+                }
+            }
+            
+            delivered += deliver_segments(static_cast<const uint8_t*>(receive_iovecs_[i].iov_base),
+                                          length, segment, handler);
+        }
+        
+        // A short batch means the socket is drained
+        if (static_cast<size_t>(result) < slots) {
+            break;
+        }
+    }
+    
+    return delivered;
+}
+
+size_t SenderReceiver::receive_packets(PacketPool& pool, const PacketHandler& handler) {
+    if (sockfd_ < 0) {
+        return 0;
+    }
+    
+    if (gro_enabled_ || pool.get_buffer_size() < max_datagram_size_) {
+        return receive_batch([&pool, &handler](ConstByteSpan datagram) {
+            PacketRef packet = pool.copy(datagram);
+            if (packet) {
+                handler(std::move(packet));
+            }
+        });
+    }
+    
+    std::unique_lock<std::mutex> lock(receive_mutex_);
+    const size_t slots = receive_msgs_.size();
+    receive_packets_.resize(slots);
+    size_t delivered = 0;
+    bool exhausted = false;
+    
+    while (running_.load()) {
+        // Arm every slot with a pool buffer; buffers left unused by a short
+        // batch stay armed for the next call
+        size_t armed = 0;
+        while (armed < slots) {
+            PacketRef& packet = receive_packets_[armed];
+            if (!packet) {
+                packet = pool.acquire();
+                if (!packet) {
+                    break;
+                }
+            }
+            receive_iovecs_[armed].iov_base = packet.mutable_data();
+            receive_iovecs_[armed].iov_len = pool.get_buffer_size();
+            armed++;
+        }
+        if (armed == 0) {
+            exhausted = true;
+            break;
+        }
+        
+        prepare_receive_headers(armed);
+        
+        int result = recvmmsg(sockfd_, receive_msgs_.data(), static_cast<unsigned int>(armed),
+                              MSG_DONTWAIT, nullptr);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EWOULDBLOCK && errno != EAGAIN) {
                 LOG_ERROR("Alma hatası: " + std::string(strerror(errno)));
-                break;
             }
-        } else {
-            // Connection closed
             break;
         }
+        
+        for (int i = 0; i < result; ++i) {
+            // Rejected datagrams leave their buffer armed for reuse
+            if (!is_from_remote(receive_addrs_[i])) {
+                continue;
+            }
+            if (receive_msgs_[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                LOG_WARNING("Datagram kesildi, max datagram boyutu yetersiz");
+                continue;
+            }
+            
+            PacketRef packet = std::move(receive_packets_[i]);
+            packet.resize(receive_msgs_[i].msg_len);
+            handler(std::move(packet));
+            delivered++;
+        }
+        
+        // A short batch means the socket is drained
+        if (static_cast<size_t>(result) < armed) {
+            break;
+        }
+    }
+    
+    // With every buffer held downstream there is nowhere to put the data;
+    // drop it rather than leave the socket readable forever
+    if (exhausted) {
+        lock.unlock();
+        size_t dropped = receive_batch([](ConstByteSpan) {});
+        LOG_WARNING("Packet pool tükendi, " + std::to_string(dropped) + " datagram atıldı");
+    }
+    
+    return delivered;
+}
+
+void SenderReceiver::prepare_receive_headers(size_t slots) {
+    const size_t control_space = CMSG_SPACE(sizeof(int));
+    for (size_t i = 0; i < slots; ++i) {
+        msghdr& hdr = receive_msgs_[i].msg_hdr;
+        hdr.msg_name = &receive_addrs_[i];
+        hdr.msg_namelen = sizeof(receive_addrs_[i]);
+        hdr.msg_control = gro_enabled_ ? receive_control_.data() + i * control_space : nullptr;
+        hdr.msg_controllen = gro_enabled_ ? control_space : 0;
+        hdr.msg_flags = 0;
+    }
+}
+
+bool SenderReceiver::is_from_remote(const struct sockaddr_in& addr) const {
+    return addr.sin_addr.s_addr == remote_addr_.sin_addr.s_addr &&
+           addr.sin_port == remote_addr_.sin_port;
+}
+
+size_t SenderReceiver::get_max_receive_size() const {
+    return gro_enabled_ ? kGroSlotSize : max_datagram_size_;
+}
+
+size_t SenderReceiver::deliver_segments(const uint8_t* data, size_t length, size_t segment_size,
+                                        const DatagramHandler& handler) {
+    if (segment_size == 0) {
+        segment_size = length;
     }
+    size_t delivered = 0;
+    for (size_t offset = 0; offset < length; offset += segment_size) {
+        handler(ConstByteSpan(data + offset, std::min(segment_size, length - offset)));
+        delivered++;
+    }
+    return delivered;
+}
+
+size_t SenderReceiver::gro_segment_size(const struct cmsghdr* cmsg) {
+    if (cmsg->cmsg_level != SOL_UDP || cmsg->cmsg_type != UDP_GRO) {
+        return 0;
+    }
+    int gso_size = 0;
+    memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+    return gso_size > 0 ? static_cast<size_t>(gso_size) : 0;
+}
+
+std::vector<std::vector<uint8_t>> SenderReceiver::receive_chunks() {
+    std::vector<std::vector<uint8_t>> received_chunks;
+    
+    receive_batch([&received_chunks](ConstByteSpan datagram) {
+        received_chunks.emplace_back(datagram.begin(), datagram.end());
+    });
     
     return received_chunks;
 }
@@ -6,25 +6,89 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <functional>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include "../common/byte_span.h"
+#include "../common/packet_pool.h"
 
 class SenderReceiver {
 public:
-    SenderReceiver(const std::string& remote_ip, uint16_t remote_port);
+    // Messages moved per sendmmsg/recvmmsg call
+    static constexpr size_t kBatchSize = 64;
+    static constexpr size_t kDefaultMaxDatagramSize = 2048;
+    
+    // UDP GSO limits: segments per send and bytes per super-datagram
+    static constexpr size_t kMaxGsoSegments = 64;
+    static constexpr size_t kMaxGsoBytes = 65000;
+    
+    // GRO coalesces up to 64 KB into one receive
+    static constexpr size_t kGroSlotSize = 65536;
+    static constexpr size_t kGroBatchSize = 8;
+    
+    // Called for each received datagram; the view is valid during the call only
+    using DatagramHandler = std::function<void(ConstByteSpan)>;
+    
+    // Called for each received datagram; the handler may keep the packet
+    using PacketHandler = std::function<void(PacketRef)>;
+    
+    SenderReceiver(const std::string& remote_ip, uint16_t remote_port,
+                   size_t max_datagram_size = kDefaultMaxDatagramSize);
     ~SenderReceiver();
     
     // Initialize socket
     bool initialize();
     
-    // Start/stop receiver thread
-    void start();
+    // Start/stop. Without its own receive thread the socket is drained by
+    // an external reactor through receive_batch().
+    void start(bool own_receive_thread = true);
     void stop();
     
+    // Probe for UDP GSO (send) and GRO (receive) support and enable
+    // whatever the kernel offers. Returns true if either is active;
+    // otherwise plain sendmmsg/recvmmsg stay in use. Call after initialize().
+    bool enable_segmentation_offload();
+    bool is_gso_enabled() const { return gso_enabled_.load(); }
+    bool is_gro_enabled() const { return gro_enabled_; }
+    
+    // Turn GRO back off so receive_packets() can recvmmsg straight into
+    // pool buffers; GSO on the send side is unaffected
+    void disable_gro();
+    
     // Send chunk data
-    void send_chunk(const std::vector<uint8_t>& chunk_data);
+    void send_chunk(ConstByteSpan chunk_data);
+    
+    // Send a whole frame's datagrams with as few sendmmsg calls as possible.
+    // With GSO, runs of equal-size datagrams (the last may be shorter) go out
+    // as one super-datagram the kernel slices back into segments.
+    // Returns the number of datagrams handed to the kernel.
+    size_t send_chunks(const ConstByteSpan* chunks, size_t count);
     
-    // Receive chunks (non-blocking)
+    // Drain the socket with recvmmsg into the preallocated receive ring and
+    // pass each datagram from the remote peer to handler (non-blocking).
+    // Returns the number of datagrams delivered.
+    size_t receive_batch(const DatagramHandler& handler);
+    
+    // Like receive_batch, but recvmmsg writes straight into buffers taken
+    // from pool and each datagram is handed over without a copy. With GRO
+    // on, receives exceed a pool buffer and are copied out per segment
+    // instead, so pool users call disable_gro().
+    size_t receive_packets(PacketPool& pool, const PacketHandler& handler);
+    
+    // Source filter and receive sizing for external receive backends
+    bool is_from_remote(const struct sockaddr_in& addr) const;
+    size_t get_max_receive_size() const;
+    
+    // Split a receive (possibly GRO coalesced into segment_size pieces) into
+    // datagrams for handler; returns the number delivered
+    static size_t deliver_segments(const uint8_t* data, size_t length, size_t segment_size,
+                                   const DatagramHandler& handler);
+    
+    // Segment size carried by a UDP_GRO control message, 0 for anything else
+    static size_t gro_segment_size(const struct cmsghdr* cmsg);
+    
+    // Receive chunks (non-blocking), copied out of the receive ring
     std::vector<std::vector<uint8_t>> receive_chunks();
     
     // Get received chunks from internal buffer
@@ -34,6 +98,7 @@ public:
     std::string get_remote_ip() const;
     uint16_t get_remote_port() const;
     uint16_t get_local_port() const;
+    int get_socket_fd() const { return sockfd_; }
     bool is_running() const;
 
 private:
@@ -42,6 +107,25 @@ private:
     uint16_t local_port_;
     int sockfd_;
     struct sockaddr_in remote_addr_;
+    size_t max_datagram_size_;
+    
+    // Preallocated sendmmsg state; one message may carry a GSO run
+    std::mutex send_mutex_;
+    std::vector<struct mmsghdr> send_msgs_;
+    std::vector<struct iovec> send_iovecs_;
+    std::vector<uint8_t> send_control_;
+    std::vector<size_t> send_counts_;  // datagrams per message
+    std::atomic<bool> gso_enabled_{false};
+    
+    // Preallocated recvmmsg ring; slots grow to kGroSlotSize with GRO
+    std::mutex receive_mutex_;
+    std::vector<uint8_t> receive_buffer_;
+    std::vector<struct mmsghdr> receive_msgs_;
+    std::vector<struct iovec> receive_iovecs_;
+    std::vector<struct sockaddr_in> receive_addrs_;
+    std::vector<uint8_t> receive_control_;
+    bool gro_enabled_;
+    std::vector<PacketRef> receive_packets_;  // pool buffers armed for receive_packets
     
     std::atomic<bool> running_{false};
     std::thread receive_thread_;
@@ -50,4 +134,8 @@ private:
     
     // Internal methods
     void receive_loop();
+    bool wait_writable(int timeout_ms);
+    void allocate_receive_ring(size_t slot_size, size_t slots);
+    void prepare_receive_headers(size_t slots);
+    size_t build_send_batch(const ConstByteSpan* chunks, size_t count, bool use_gso);
 };
\ No newline at end of file
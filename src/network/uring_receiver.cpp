@@ -0,0 +1,306 @@
+// src/network/uring_receiver.cpp
+#include "uring_receiver.h"
+
+#ifdef IO_URING_AVAILABLE
+#include "../common/logger.h"
+#include <sys/eventfd.h>
+#include <sys/utsname.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+constexpr uint64_t kWakeTag = 0;
+constexpr size_t kControlSpace = CMSG_SPACE(sizeof(int));
+
+// Multishot recvmsg arrived in Linux 6.0
+bool kernel_supports_multishot_recvmsg() {
+    struct utsname name;
+    int major = 0;
+    int minor = 0;
+    if (uname(&name) != 0 || std::sscanf(name.release, "%d.%d", &major, &minor) != 2) {
+        return false;
+    }
+    return major >= 6;
+}
+
+} // namespace
+
+UringReceiver::UringReceiver()
+    : ring_ready_(false), wake_fd_(-1), buffer_ring_(nullptr),
+      buffer_size_(0), buffer_count_(0), tick_interval_(0) {
+    std::memset(&ring_, 0, sizeof(ring_));
+    std::memset(&recv_template_, 0, sizeof(recv_template_));
+}
+
+UringReceiver::~UringReceiver() {
+    stop();
+    if (buffer_ring_) {
+        io_uring_free_buf_ring(&ring_, buffer_ring_, buffer_count_, kBufferGroup);
+    }
+    if (ring_ready_) {
+        io_uring_queue_exit(&ring_);
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+}
+
+bool UringReceiver::initialize() {
+    if (!kernel_supports_multishot_recvmsg()) {
+        LOG_WARNING("Kernel multishot recvmsg desteklemiyor (>= 6.0 gerekli)");
+        return false;
+    }
+
+    int ret = io_uring_queue_init(kQueueDepth, &ring_, 0);
+    if (ret < 0) {
+        LOG_WARNING("io_uring başlatılamadı: " + std::string(strerror(-ret)));
+        return false;
+    }
+    ring_ready_ = true;
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        LOG_ERROR("eventfd oluşturulamadı: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    // Every receive reserves room for the source address and a GRO cmsg
+    recv_template_.msg_namelen = sizeof(struct sockaddr_in);
+    recv_template_.msg_controllen = kControlSpace;
+
+    return true;
+}
+
+bool UringReceiver::add(SenderReceiver* socket, SenderReceiver::DatagramHandler handler) {
+    if (!ring_ready_ || running_.load() || !socket || socket->get_socket_fd() < 0) {
+        return false;
+    }
+
+    sockets_.push_back({socket, std::move(handler)});
+    return true;
+}
+
+bool UringReceiver::setup_buffers() {
+    size_t max_payload = 0;
+    for (const auto& entry : sockets_) {
+        max_payload = std::max(max_payload, entry.socket->get_max_receive_size());
+    }
+
+    // Each buffer holds the recvmsg header, address, control data and payload
+    buffer_size_ = sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_in) +
+                   kControlSpace + max_payload;
+    buffer_count_ = buffer_size_ > 16384 ? 64 : 512;
+    buffers_.assign(buffer_size_ * buffer_count_, 0);
+
+    int ret = 0;
+    buffer_ring_ = io_uring_setup_buf_ring(&ring_, buffer_count_, kBufferGroup, 0, &ret);
+    if (!buffer_ring_) {
+        LOG_ERROR("io_uring buffer ring kurulamadı: " + std::string(strerror(-ret)));
+        return false;
+    }
+
+    int mask = io_uring_buf_ring_mask(buffer_count_);
+    for (unsigned i = 0; i < buffer_count_; ++i) {
+        io_uring_buf_ring_add(buffer_ring_, buffers_.data() + i * buffer_size_,
+                              static_cast<unsigned>(buffer_size_), static_cast<unsigned short>(i),
+                              mask, static_cast<int>(i));
+    }
+    io_uring_buf_ring_advance(buffer_ring_, static_cast<int>(buffer_count_));
+
+    return true;
+}
+
+void UringReceiver::start() {
+    if (running_.load()) {
+        LOG_WARNING("UringReceiver zaten çalışıyor");
+        return;
+    }
+
+    if (!ring_ready_ || !setup_buffers()) {
+        LOG_ERROR("UringReceiver başlatılamadı");
+        return;
+    }
+
+    for (size_t i = 0; i < sockets_.size(); ++i) {
+        arm(i);
+    }
+    arm_wake();
+    io_uring_submit(&ring_);
+
+    running_ = true;
+    receiver_thread_ = std::thread(&UringReceiver::receiver_loop, this);
+
+    LOG_INFO("UringReceiver başlatıldı (" + std::to_string(sockets_.size()) + " socket)");
+}
+
+void UringReceiver::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    running_ = false;
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written;
+
+    if (receiver_thread_.joinable()) {
+        receiver_thread_.join();
+    }
+
+    LOG_INFO("UringReceiver durduruldu");
+}
+
+void UringReceiver::arm(size_t index) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    if (!sqe) {
+        io_uring_submit(&ring_);
+        sqe = io_uring_get_sqe(&ring_);
+    }
+
+    io_uring_prep_recvmsg_multishot(sqe, sockets_[index].socket->get_socket_fd(), &recv_template_, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    io_uring_sqe_set_data64(sqe, index + 1);
+}
+
+void UringReceiver::arm_wake() {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    if (!sqe) {
+        io_uring_submit(&ring_);
+        sqe = io_uring_get_sqe(&ring_);
+    }
+
+    io_uring_prep_poll_add(sqe, wake_fd_, POLLIN);
+    io_uring_sqe_set_data64(sqe, kWakeTag);
+}
+
+void UringReceiver::recycle(uint16_t buffer_id) {
+    io_uring_buf_ring_add(buffer_ring_, buffers_.data() + buffer_id * buffer_size_,
+                          static_cast<unsigned>(buffer_size_), buffer_id,
+                          io_uring_buf_ring_mask(buffer_count_), 0);
+    io_uring_buf_ring_advance(buffer_ring_, 1);
+}
+
+void UringReceiver::handle_completion(struct io_uring_cqe* cqe) {
+    uint64_t tag = io_uring_cqe_get_data64(cqe);
+
+    if (tag == kWakeTag) {
+        uint64_t value;
+        ssize_t bytes_read = read(wake_fd_, &value, sizeof(value));
+        (void)bytes_read;
+        if (running_.load()) {
+            arm_wake();
+        }
+        return;
+    }
+
+    size_t index = static_cast<size_t>(tag - 1);
+    if (index >= sockets_.size()) {
+        return;
+    }
+
+    // Without F_MORE the multishot request has ended (e.g. the buffer ring
+    // ran dry) and must be re-armed
+    bool more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+
+    if (cqe->res < 0) {
+        if (cqe->res != -ENOBUFS) {
+            LOG_ERROR("io_uring recvmsg hatası: " + std::string(strerror(-cqe->res)));
+        }
+    } else if (cqe->flags & IORING_CQE_F_BUFFER) {
+        uint16_t buffer_id = static_cast<uint16_t>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        uint8_t* buffer = buffers_.data() + buffer_id * buffer_size_;
+
+        struct io_uring_recvmsg_out* out = io_uring_recvmsg_validate(buffer, cqe->res, &recv_template_);
+        if (out && out->namelen >= sizeof(struct sockaddr_in)) {
+            Socket& entry = sockets_[index];
+            struct sockaddr_in addr;
+            std::memcpy(&addr, io_uring_recvmsg_name(out), sizeof(addr));
+
+            if (out->flags & MSG_TRUNC) {
+                LOG_WARNING("Datagram kesildi, max datagram boyutu yetersiz");
+            } else if (entry.socket->is_from_remote(addr)) {
+                size_t length = io_uring_recvmsg_payload_length(out, cqe->res, &recv_template_);
+                size_t segment = length;
+                for (struct cmsghdr* cmsg = io_uring_recvmsg_cmsg_firsthdr(out, &recv_template_); cmsg;
+                     cmsg = io_uring_recvmsg_cmsg_nexthdr(out, &recv_template_, cmsg)) {
+                    if (size_t gso_size = SenderReceiver::gro_segment_size(cmsg)) {
+                        segment = gso_size;
+                    }
+                }
+
+                try {
+                    SenderReceiver::deliver_segments(
+                        static_cast<const uint8_t*>(io_uring_recvmsg_payload(out, &recv_template_)),
+                        length, segment, entry.handler);
+                } catch (const std::exception& e) {
+                    LOG_ERROR("UringReceiver handler hatası: " + std::string(e.what()));
+                }
+            }
+        }
+
+        recycle(buffer_id);
+    }
+
+    if (!more && running_.load()) {
+        arm(index);
+    }
+}
+
+void UringReceiver::set_tick(std::chrono::milliseconds interval, std::function<void()> handler) {
+    tick_interval_ = interval;
+    tick_handler_ = std::move(handler);
+}
+
+void UringReceiver::receiver_loop() {
+    auto next_tick = std::chrono::steady_clock::now() + tick_interval_;
+    while (running_.load()) {
+        int ret;
+        if (tick_handler_ && tick_interval_.count() > 0) {
+            // Wait no longer than until the next tick is due
+            auto wait = std::max(next_tick - std::chrono::steady_clock::now(),
+                                 std::chrono::steady_clock::duration::zero());
+            auto wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+            struct __kernel_timespec timeout{};
+            timeout.tv_sec = wait_ns / 1000000000;
+            timeout.tv_nsec = wait_ns % 1000000000;
+            struct io_uring_cqe* first;
+            ret = io_uring_submit_and_wait_timeout(&ring_, &first, 1, &timeout, nullptr);
+            if (ret == -ETIME) {
+                ret = 0;
+            }
+        } else {
+            ret = io_uring_submit_and_wait(&ring_, 1);
+        }
+        if (ret < 0 && ret != -EINTR) {
+            LOG_ERROR("io_uring bekleme hatası: " + std::string(strerror(-ret)));
+            continue;
+        }
+
+        struct io_uring_cqe* cqe;
+        unsigned head;
+        unsigned count = 0;
+        io_uring_for_each_cqe(&ring_, head, cqe) {
+            handle_completion(cqe);
+            count++;
+        }
+        io_uring_cq_advance(&ring_, count);
+
+        if (tick_handler_ && std::chrono::steady_clock::now() >= next_tick) {
+            next_tick = std::chrono::steady_clock::now() + tick_interval_;
+            try {
+                tick_handler_();
+            } catch (const std::exception& e) {
+                LOG_ERROR("UringReceiver tick hatası: " + std::string(e.what()));
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+// src/network/uring_receiver.h
+#pragma once
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include "sender_receiver.h"
+
+// io_uring receive backend: one thread services every path socket with a
+// multishot recvmsg per socket, and the kernel picks receive buffers from a
+// registered (provided) buffer ring. Datagrams are handed to the socket's
+// handler straight out of the ring, so steady state needs no syscall per
+// datagram or per socket. Sending stays on SenderReceiver::send_chunks.
+//
+// Sockets must be added before start(). Built only with liburing; otherwise
+// initialize() fails and the Engine falls back to the epoll Reactor.
+#ifdef IO_URING_AVAILABLE
+#include <liburing.h>
+
+class UringReceiver {
+public:
+    static constexpr unsigned kQueueDepth = 64;
+    static constexpr uint16_t kBufferGroup = 1;
+
+    UringReceiver();
+    ~UringReceiver();
+
+    // Set up the ring; false if the kernel lacks io_uring
+    bool initialize();
+
+    // Service socket's receives; handler runs on the receiver thread
+    bool add(SenderReceiver* socket, SenderReceiver::DatagramHandler handler);
+
+    // Also run handler on the receiver thread every interval, whether or
+    // not datagrams arrive. Set before start().
+    void set_tick(std::chrono::milliseconds interval, std::function<void()> handler);
+
+    // Start/stop receiver thread
+    void start();
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+
+private:
+    struct Socket {
+        SenderReceiver* socket;
+        SenderReceiver::DatagramHandler handler;
+    };
+
+    struct io_uring ring_;
+    bool ring_ready_;
+    int wake_fd_;
+    std::vector<Socket> sockets_;
+
+    // Provided buffer ring
+    struct io_uring_buf_ring* buffer_ring_;
+    std::vector<uint8_t> buffers_;
+    size_t buffer_size_;
+    unsigned buffer_count_;
+
+    // Template for multishot recvmsg: address and GRO control space
+    struct msghdr recv_template_;
+
+    std::chrono::milliseconds tick_interval_;
+    std::function<void()> tick_handler_;
+
+    std::atomic<bool> running_{false};
+    std::thread receiver_thread_;
+
+    bool setup_buffers();
+    void arm(size_t index);
+    void arm_wake();
+    void recycle(uint16_t buffer_id);
+    void handle_completion(struct io_uring_cqe* cqe);
+    void receiver_loop();
+};
+#else
+// liburing yoksa dummy class
+#include <cstddef>
+#include <chrono>
+#include <functional>
+
+class UringReceiver {
+public:
+    bool initialize() { return false; }
+    bool add(SenderReceiver*, SenderReceiver::DatagramHandler) { return false; }
+    void set_tick(std::chrono::milliseconds, std::function<void()>) {}
+    void start() {}
+    void stop() {}
+    bool is_running() const { return false; }
+};
+#endif
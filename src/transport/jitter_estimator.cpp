@@ -0,0 +1,83 @@
+// src/transport/jitter_estimator.cpp
+#include "jitter_estimator.h"
+#include "packet_header.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+JitterEstimator::JitterEstimator(const Config& config)
+    : config_(config), have_timestamp_(false), last_timestamp_(0), last_extended_(0),
+      have_transit_(false), last_transit_ms_(0.0), jitter_ms_(0.0), base_transit_ms_(0.0),
+      target_delay_ms_(config.min_delay_ms) {
+
+    transits_.reserve(kMaxSamples);
+
+    if (config.max_delay_ms < config.min_delay_ms || config.percentile <= 0.0 ||
+        config.percentile > 1.0 || config.window_ms == 0 || config.decay <= 0.0 || config.decay > 1.0) {
+        throw std::invalid_argument("Geçersiz jitter estimator parametreleri");
+    }
+}
+
+void JitterEstimator::on_frame(uint32_t timestamp, Clock::time_point arrival) {
+    int64_t extended = extend(timestamp);
+    if (!have_timestamp_ || extended > last_extended_) {
+        have_timestamp_ = true;
+        last_timestamp_ = timestamp;
+        last_extended_ = extended;
+    }
+
+    const double arrival_ms = to_ms(arrival);
+    const double transit_ms = arrival_ms - extended * 1000.0 / kMediaClockRate;
+
+    // RFC 3550 section 6.4.1: J += (|D| - J) / 16
+    if (have_transit_) {
+        jitter_ms_ += (std::fabs(transit_ms - last_transit_ms_) - jitter_ms_) / 16.0;
+    }
+    have_transit_ = true;
+    last_transit_ms_ = transit_ms;
+
+    samples_.emplace_back(arrival_ms, transit_ms);
+    while (samples_.size() > kMaxSamples ||
+           (samples_.size() > 1 && arrival_ms - samples_.front().first > config_.window_ms)) {
+        samples_.pop_front();
+    }
+
+    // Fastest transit and the percentile above it
+    std::vector<double>& transits = transits_;
+    transits.clear();
+    for (const auto& sample : samples_) {
+        transits.push_back(sample.second);
+    }
+    base_transit_ms_ = *std::min_element(transits.begin(), transits.end());
+    size_t rank = static_cast<size_t>(config_.percentile * (transits.size() - 1));
+    std::nth_element(transits.begin(), transits.begin() + rank, transits.end());
+    double spread_ms = transits[rank] - base_transit_ms_;
+
+    double desired = std::max(spread_ms, config_.jitter_multiplier * jitter_ms_);
+    if (desired >= target_delay_ms_) {
+        target_delay_ms_ = desired;
+    } else {
+        target_delay_ms_ -= (target_delay_ms_ - desired) * config_.decay;
+    }
+    target_delay_ms_ = std::min(std::max(target_delay_ms_, static_cast<double>(config_.min_delay_ms)),
+                                static_cast<double>(config_.max_delay_ms));
+}
+
+JitterEstimator::Clock::time_point JitterEstimator::playout_time(uint32_t timestamp) const {
+    double playout_ms = extend(timestamp) * 1000.0 / kMediaClockRate + base_transit_ms_ + target_delay_ms_;
+    return Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(playout_ms)));
+}
+
+int64_t JitterEstimator::extend(uint32_t timestamp) const {
+    // Timestamps wrap every 13 hours; place this one nearest the last
+    if (!have_timestamp_) {
+        return timestamp;
+    }
+    return last_extended_ + static_cast<int32_t>(timestamp - last_timestamp_);
+}
+
+double JitterEstimator::to_ms(Clock::time_point time) {
+    return std::chrono::duration<double, std::milli>(time.time_since_epoch()).count();
+}
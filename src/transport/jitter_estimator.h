@@ -0,0 +1,71 @@
+// src/transport/jitter_estimator.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Playout delay estimation for the receive buffer. Each frame contributes
+// one sample when it becomes complete: its transit time, local completion
+// time minus the sender's capture timestamp (the clock offset between the
+// two is unknown but constant, so only differences matter).
+//
+// - The RFC 3550 interarrival jitter J is a running mean of the transit
+//   change between consecutive frames; it reacts within a few frames.
+// - A percentile tracker keeps the transits of the last few seconds. Its
+//   minimum is the fastest transit (the playout base), and the gap up to
+//   the chosen percentile is the delay that covers most frames.
+//
+// The target delay is the larger of the percentile gap and a multiple of J.
+// It grows at once and shrinks gradually, so a clean network settles to a
+// few milliseconds while a jittery one gets room to avoid stutter. A frame
+// plays at capture time + base + target.
+class JitterEstimator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        uint32_t min_delay_ms;
+        uint32_t max_delay_ms;
+        double percentile;         // share of frames the target should cover
+        uint32_t window_ms;        // history of the percentile tracker
+        double jitter_multiplier;  // target floor in units of J
+        double decay;              // share of the excess dropped per frame
+
+        Config() : min_delay_ms(0), max_delay_ms(100), percentile(0.95), window_ms(5000),
+                   jitter_multiplier(2.0), decay(0.02) {}
+    };
+
+    explicit JitterEstimator(const Config& config = Config());
+
+    // Record a frame captured at timestamp (90 kHz) that completed at arrival
+    void on_frame(uint32_t timestamp, Clock::time_point arrival);
+
+    // Whether playout_time has a base yet
+    bool has_estimate() const { return !samples_.empty(); }
+
+    // Local time at which the frame captured at timestamp should be played
+    Clock::time_point playout_time(uint32_t timestamp) const;
+
+    double get_jitter_ms() const { return jitter_ms_; }
+    double get_target_delay_ms() const { return target_delay_ms_; }
+
+private:
+    static constexpr size_t kMaxSamples = 1024;
+
+    Config config_;
+    bool have_timestamp_;
+    uint32_t last_timestamp_;
+    int64_t last_extended_;         // unwrapped last_timestamp_
+    bool have_transit_;
+    double last_transit_ms_;
+    double jitter_ms_;
+    double base_transit_ms_;
+    double target_delay_ms_;
+    std::deque<std::pair<double, double>> samples_;  // (arrival ms, transit ms)
+    std::vector<double> transits_;                   // percentile scratch, kMaxSamples reserved
+
+    int64_t extend(uint32_t timestamp) const;
+    static double to_ms(Clock::time_point time);
+};
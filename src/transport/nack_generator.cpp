@@ -0,0 +1,84 @@
+// src/transport/nack_generator.cpp
+#include "nack_generator.h"
+#include "packet_header.h"
+#include <stdexcept>
+
+NackGenerator::NackGenerator(const Config& config)
+    : config_(config), have_rtt_(false), rtt_ms_(config.initial_rtt_ms), requests_sent_(0) {
+
+    if (config.retry_factor <= 0.0 || config.max_retries <= 0 || config.max_requests == 0) {
+        throw std::invalid_argument("Geçersiz NACK parametreleri");
+    }
+}
+
+bool NackGenerator::on_missing(uint32_t sequence_number, uint16_t chunk_id, Clock::time_point deadline,
+                               Clock::time_point now) {
+    const uint64_t key = key_for(sequence_number, chunk_id);
+    auto it = requests_.find(key);
+    if (it == requests_.end()) {
+        if (requests_.size() >= config_.max_requests) {
+            return false;
+        }
+        it = requests_.emplace(key, Request{now, now, 0}).first;
+    }
+    Request& request = it->second;
+
+    if (request.sent >= config_.max_retries) {
+        return false;
+    }
+    if (request.sent == 0) {
+        if (now - request.first_seen < std::chrono::milliseconds(config_.reorder_delay_ms)) {
+            return false;
+        }
+    } else if (now - request.last_sent <
+               std::chrono::duration<double, std::milli>(rtt_ms_ * config_.retry_factor)) {
+        return false;
+    }
+
+    // The resend needs a round trip; past the deadline it would be dropped
+    if (now + std::chrono::duration_cast<Clock::duration>(
+                  std::chrono::duration<double, std::milli>(rtt_ms_)) > deadline) {
+        return false;
+    }
+
+    request.last_sent = now;
+    request.sent++;
+    requests_sent_++;
+    return true;
+}
+
+void NackGenerator::on_retransmission(uint32_t sequence_number, uint16_t chunk_id, Clock::time_point now) {
+    // A frame asked for whole is answered chunk by chunk; its first chunk
+    // settles the request
+    auto it = requests_.find(key_for(sequence_number, chunk_id));
+    if (it == requests_.end()) {
+        it = requests_.find(key_for(sequence_number, NackHeader::kWholeFrame));
+        if (it == requests_.end()) {
+            return;
+        }
+    }
+
+    // Only a single request says which NACK the resend answers
+    if (it->second.sent == 1) {
+        double sample_ms = std::chrono::duration<double, std::milli>(now - it->second.last_sent).count();
+        if (!have_rtt_) {
+            have_rtt_ = true;
+            rtt_ms_ = sample_ms;
+        } else {
+            rtt_ms_ += (sample_ms - rtt_ms_) / 8.0;
+        }
+    }
+    requests_.erase(it);
+}
+
+void NackGenerator::prune(uint32_t sequence_number) {
+    auto it = requests_.begin();
+    while (it != requests_.end()) {
+        uint32_t request_sequence = static_cast<uint32_t>(it->first >> 16);
+        if (static_cast<int32_t>(request_sequence - sequence_number) < 0) {
+            it = requests_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+// src/transport/nack_generator.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
+
+// Decides when a missing data chunk is worth a NACK. The collector finds
+// the gaps; this keeps one request per missing (sequence, chunk) and
+//
+// - waits reorder_delay_ms after a gap is first seen, so packets that are
+//   only reordered (another path, a late burst) are not asked for,
+// - asks again at most every retry_factor round trips, max_retries times,
+// - never asks when the resend could not arrive before the frame's
+//   deadline (now + RTT past it).
+//
+// The round trip is measured from the NACK to the arrival of the
+// retransmission it asked for, for requests sent only once (as in Karn's
+// algorithm), and smoothed like TCP's SRTT.
+class NackGenerator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        uint32_t reorder_delay_ms;
+        uint32_t initial_rtt_ms;  // until the first retransmission arrives
+        double retry_factor;      // round trips between requests for a chunk
+        int max_retries;
+        size_t max_requests;      // outstanding requests tracked
+
+        Config() : reorder_delay_ms(10), initial_rtt_ms(100), retry_factor(1.5), max_retries(3),
+                   max_requests(4096) {}
+    };
+
+    explicit NackGenerator(const Config& config = Config());
+
+    // A chunk (or with NackHeader::kWholeFrame a whole frame) is missing at
+    // now; returns true if it should be requested now
+    bool on_missing(uint32_t sequence_number, uint16_t chunk_id, Clock::time_point deadline,
+                    Clock::time_point now);
+
+    // A retransmitted chunk arrived
+    void on_retransmission(uint32_t sequence_number, uint16_t chunk_id, Clock::time_point now);
+
+    // Forget requests for frames older than sequence_number
+    void prune(uint32_t sequence_number);
+
+    double get_rtt_ms() const { return rtt_ms_; }
+    uint64_t get_request_count() const { return requests_sent_; }
+
+private:
+    struct Request {
+        Clock::time_point first_seen;
+        Clock::time_point last_sent;
+        int sent;
+    };
+
+    Config config_;
+    std::map<uint64_t, Request> requests_;  // (sequence_number << 16 | chunk_id)
+    bool have_rtt_;
+    double rtt_ms_;
+    uint64_t requests_sent_;
+
+    static uint64_t key_for(uint32_t sequence_number, uint16_t chunk_id) {
+        return (static_cast<uint64_t>(sequence_number) << 16) | chunk_id;
+    }
+};
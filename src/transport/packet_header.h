@@ -0,0 +1,480 @@
+// src/transport/packet_header.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// Every datagram starts with the frame sequence number (the report counter
+// for feedback) and carries its packet type at byte 10 (the former reserved
+// field of the Slicer header, which is zero for data chunks).
+enum PacketType : uint8_t {
+    PACKET_DATA = 0,
+    PACKET_FEC = 1,
+    PACKET_FEC_INTERLEAVED = 2,
+    PACKET_FEEDBACK = 3,
+    PACKET_NACK = 4,
+    PACKET_KEYFRAME_REQUEST = 5
+};
+
+constexpr size_t kPacketTypeOffset = 10;
+
+inline bool peek_packet_type(const uint8_t* data, size_t size, PacketType& type) {
+    if (size <= kPacketTypeOffset) {
+        return false;
+    }
+    type = static_cast<PacketType>(data[kPacketTypeOffset]);
+    return true;
+}
+
+// Data chunk header: 16 bytes
+// - sequence_number (4 bytes)
+// - chunk_id (2 bytes)
+// - total_chunks (2 bytes)
+// - chunk_size (2 bytes)
+// - packet type (1 byte, PACKET_DATA)
+// - flags (1 byte)
+// - timestamp (4 bytes): capture time of the frame, 90 kHz sender clock
+struct DataHeader {
+    static constexpr size_t kSize = 16;
+    static constexpr size_t kFlagsOffset = 11;
+    static constexpr uint8_t kFlagRetransmission = 0x01;  // resent on a NACK
+
+    uint32_t sequence_number;
+    uint16_t chunk_id;
+    uint16_t total_chunks;
+    uint16_t chunk_size;
+    uint8_t flags;
+    uint32_t timestamp;
+
+    DataHeader() : sequence_number(0), chunk_id(0), total_chunks(0), chunk_size(0), flags(0), timestamp(0) {}
+
+    bool is_retransmission() const { return (flags & kFlagRetransmission) != 0; }
+
+    void write(uint8_t* out) const {
+        std::memcpy(out, &sequence_number, 4);
+        std::memcpy(out + 4, &chunk_id, 2);
+        std::memcpy(out + 6, &total_chunks, 2);
+        std::memcpy(out + 8, &chunk_size, 2);
+        out[10] = PACKET_DATA;
+        out[11] = flags;
+        std::memcpy(out + 12, &timestamp, 4);
+    }
+
+    static bool parse(const uint8_t* in, size_t size, DataHeader& header) {
+        if (size < kSize || in[kPacketTypeOffset] != PACKET_DATA) {
+            return false;
+        }
+        std::memcpy(&header.sequence_number, in, 4);
+        std::memcpy(&header.chunk_id, in + 4, 2);
+        std::memcpy(&header.total_chunks, in + 6, 2);
+        std::memcpy(&header.chunk_size, in + 8, 2);
+        header.flags = in[kFlagsOffset];
+        std::memcpy(&header.timestamp, in + 12, 4);
+        return true;
+    }
+};
+
+// Media clock of DataHeader::timestamp
+constexpr uint32_t kMediaClockRate = 90000;
+
+// FEC parity header: 20 bytes
+// - sequence_number (4 bytes)
+// - block_id (2 bytes): data chunks [block_id * k, block_id * k + k) of the frame
+// - total_chunks (2 bytes): data chunks in the frame
+// - symbol_size (2 bytes): Slicer max chunk size
+// - packet type (1 byte, PACKET_FEC)
+// - index (1 byte): position within the k+r block, k..k+r-1 for parity
+// - frame_length (4 bytes): original encoded frame size
+// - k (1 byte), r (1 byte)
+// - reserved (2 bytes)
+struct FecHeader {
+    static constexpr size_t kSize = 20;
+
+    uint32_t sequence_number;
+    uint16_t block_id;
+    uint16_t total_chunks;
+    uint16_t symbol_size;
+    uint8_t index;
+    uint32_t frame_length;
+    uint8_t k;
+    uint8_t r;
+
+    FecHeader() : sequence_number(0), block_id(0), total_chunks(0), symbol_size(0),
+                  index(0), frame_length(0), k(0), r(0) {}
+
+    void write(uint8_t* out) const {
+        std::memcpy(out, &sequence_number, 4);
+        std::memcpy(out + 4, &block_id, 2);
+        std::memcpy(out + 6, &total_chunks, 2);
+        std::memcpy(out + 8, &symbol_size, 2);
+        out[10] = PACKET_FEC;
+        out[11] = index;
+        std::memcpy(out + 12, &frame_length, 4);
+        out[16] = k;
+        out[17] = r;
+        out[18] = 0;
+        out[19] = 0;
+    }
+
+    static bool parse(const uint8_t* in, size_t size, FecHeader& header) {
+        if (size < kSize || in[kPacketTypeOffset] != PACKET_FEC) {
+            return false;
+        }
+        std::memcpy(&header.sequence_number, in, 4);
+        std::memcpy(&header.block_id, in + 4, 2);
+        std::memcpy(&header.total_chunks, in + 6, 2);
+        std::memcpy(&header.symbol_size, in + 8, 2);
+        header.index = in[11];
+        std::memcpy(&header.frame_length, in + 12, 4);
+        header.k = in[16];
+        header.r = in[17];
+        return true;
+    }
+};
+
+// Interleaved FEC parity header: 16 bytes + frame table + member table.
+// The block's data symbols are Slicer chunks taken from up to 255
+// consecutive frames, listed explicitly so the receiver can find them.
+// - base_sequence (4 bytes): first frame covered by the block
+// - block_id (2 bytes): sender-side block counter
+// - symbol_size (2 bytes)
+// - frame_count (1 byte), member_count (1 byte)
+// - packet type (1 byte, PACKET_FEC_INTERLEAVED)
+// - index (1 byte): position within the k+r block, k..k+r-1 for parity
+// - k (1 byte), r (1 byte)
+// - reserved (2 bytes)
+// - frames: sequence offset (1), reserved (1), total_chunks (2), frame_length (4)
+// - members, in column order: frame index (1), chunk_id (2)
+struct InterleavedFecHeader {
+    static constexpr size_t kFixedSize = 16;
+    static constexpr size_t kFrameEntrySize = 8;
+    static constexpr size_t kMemberEntrySize = 3;
+
+    struct FrameEntry {
+        uint32_t sequence_number;
+        uint16_t total_chunks;
+        uint32_t frame_length;
+    };
+
+    struct Member {
+        uint8_t frame_index;
+        uint16_t chunk_id;
+    };
+
+    uint32_t base_sequence;
+    uint16_t block_id;
+    uint16_t symbol_size;
+    uint8_t index;
+    uint8_t k;
+    uint8_t r;
+    std::vector<FrameEntry> frames;
+    std::vector<Member> members;
+
+    InterleavedFecHeader() : base_sequence(0), block_id(0), symbol_size(0),
+                             index(0), k(0), r(0) {}
+
+    size_t size() const {
+        return kFixedSize + frames.size() * kFrameEntrySize + members.size() * kMemberEntrySize;
+    }
+
+    // Largest header a block of k members can need
+    static size_t max_size(int k) {
+        return kFixedSize + k * (kFrameEntrySize + kMemberEntrySize);
+    }
+
+    void write(uint8_t* out) const {
+        std::memcpy(out, &base_sequence, 4);
+        std::memcpy(out + 4, &block_id, 2);
+        std::memcpy(out + 6, &symbol_size, 2);
+        out[8] = static_cast<uint8_t>(frames.size());
+        out[9] = static_cast<uint8_t>(members.size());
+        out[10] = PACKET_FEC_INTERLEAVED;
+        out[11] = index;
+        out[12] = k;
+        out[13] = r;
+        out[14] = 0;
+        out[15] = 0;
+
+        uint8_t* p = out + kFixedSize;
+        for (const auto& frame : frames) {
+            p[0] = static_cast<uint8_t>(frame.sequence_number - base_sequence);
+            p[1] = 0;
+            std::memcpy(p + 2, &frame.total_chunks, 2);
+            std::memcpy(p + 4, &frame.frame_length, 4);
+            p += kFrameEntrySize;
+        }
+        for (const auto& member : members) {
+            p[0] = member.frame_index;
+            std::memcpy(p + 1, &member.chunk_id, 2);
+            p += kMemberEntrySize;
+        }
+    }
+
+    static bool parse(const uint8_t* in, size_t size, InterleavedFecHeader& header) {
+        if (size < kFixedSize || in[kPacketTypeOffset] != PACKET_FEC_INTERLEAVED) {
+            return false;
+        }
+        std::memcpy(&header.base_sequence, in, 4);
+        std::memcpy(&header.block_id, in + 4, 2);
+        std::memcpy(&header.symbol_size, in + 6, 2);
+        size_t frame_count = in[8];
+        size_t member_count = in[9];
+        header.index = in[11];
+        header.k = in[12];
+        header.r = in[13];
+
+        if (size < kFixedSize + frame_count * kFrameEntrySize + member_count * kMemberEntrySize) {
+            return false;
+        }
+
+        const uint8_t* p = in + kFixedSize;
+        header.frames.resize(frame_count);
+        for (auto& frame : header.frames) {
+            frame.sequence_number = header.base_sequence + p[0];
+            std::memcpy(&frame.total_chunks, p + 2, 2);
+            std::memcpy(&frame.frame_length, p + 4, 4);
+            p += kFrameEntrySize;
+        }
+        header.members.resize(member_count);
+        for (auto& member : header.members) {
+            member.frame_index = p[0];
+            std::memcpy(&member.chunk_id, p + 1, 2);
+            if (member.frame_index >= frame_count) {
+                return false;
+            }
+            p += kMemberEntrySize;
+        }
+        return true;
+    }
+};
+
+// Receiver feedback: 20 bytes + 10 bytes per entry. Lists the arrival time
+// of every media packet received since the previous report, in arrival order.
+// - report_sequence (4 bytes): counts reports, so lost reports are noticed
+// - entry_count (2 bytes)
+// - report_delay_us (4 bytes): time from the last entry's arrival until the
+//   report was sent, so the sender can take it out of its RTT sample
+// - packet type (1 byte, PACKET_FEEDBACK)
+// - reserved (1 byte)
+// - base_time_us (8 bytes): receiver clock at the first arrival
+// - entries: sequence_number (4), packet_id (2), arrival offset from base in us (4)
+struct FeedbackHeader {
+    static constexpr size_t kFixedSize = 20;
+    static constexpr size_t kEntrySize = 10;
+
+    struct Entry {
+        uint32_t sequence_number;
+        uint16_t packet_id;     // see feedback_packet_id()
+        uint32_t arrival_offset_us;
+    };
+
+    uint32_t report_sequence;
+    uint32_t report_delay_us;
+    uint64_t base_time_us;
+    std::vector<Entry> entries;
+
+    FeedbackHeader() : report_sequence(0), report_delay_us(0), base_time_us(0) {}
+
+    size_t size() const {
+        return kFixedSize + entries.size() * kEntrySize;
+    }
+
+    // Entries that fit in a datagram of the given size
+    static size_t max_entries(size_t datagram_size) {
+        return datagram_size > kFixedSize ? (datagram_size - kFixedSize) / kEntrySize : 0;
+    }
+
+    void write(uint8_t* out) const {
+        uint16_t entry_count = static_cast<uint16_t>(entries.size());
+        std::memcpy(out, &report_sequence, 4);
+        std::memcpy(out + 4, &entry_count, 2);
+        std::memcpy(out + 6, &report_delay_us, 4);
+        out[10] = PACKET_FEEDBACK;
+        out[11] = 0;
+        std::memcpy(out + 12, &base_time_us, 8);
+
+        uint8_t* p = out + kFixedSize;
+        for (const auto& entry : entries) {
+            std::memcpy(p, &entry.sequence_number, 4);
+            std::memcpy(p + 4, &entry.packet_id, 2);
+            std::memcpy(p + 6, &entry.arrival_offset_us, 4);
+            p += kEntrySize;
+        }
+    }
+
+    static bool parse(const uint8_t* in, size_t size, FeedbackHeader& header) {
+        if (size < kFixedSize || in[kPacketTypeOffset] != PACKET_FEEDBACK) {
+            return false;
+        }
+        uint16_t entry_count;
+        std::memcpy(&header.report_sequence, in, 4);
+        std::memcpy(&entry_count, in + 4, 2);
+        std::memcpy(&header.report_delay_us, in + 6, 4);
+        std::memcpy(&header.base_time_us, in + 12, 8);
+        if (size < kFixedSize + static_cast<size_t>(entry_count) * kEntrySize) {
+            return false;
+        }
+
+        const uint8_t* p = in + kFixedSize;
+        header.entries.resize(entry_count);
+        for (auto& entry : header.entries) {
+            std::memcpy(&entry.sequence_number, p, 4);
+            std::memcpy(&entry.packet_id, p + 4, 2);
+            std::memcpy(&entry.arrival_offset_us, p + 6, 4);
+            p += kEntrySize;
+        }
+        return true;
+    }
+};
+
+// Negative acknowledgement: 12 bytes + 6 bytes per entry. Asks the sender to
+// resend data chunks the receiver found missing.
+// - report_sequence (4 bytes): counts NACK messages
+// - entry_count (2 bytes)
+// - reserved (4 bytes)
+// - packet type (1 byte, PACKET_NACK)
+// - reserved (1 byte)
+// - entries: sequence_number (4), chunk_id (2); kWholeFrame asks for every
+//   data chunk of a frame none of whose packets arrived
+struct NackHeader {
+    static constexpr size_t kFixedSize = 12;
+    static constexpr size_t kEntrySize = 6;
+    static constexpr uint16_t kWholeFrame = 0xFFFF;
+
+    struct Entry {
+        uint32_t sequence_number;
+        uint16_t chunk_id;
+    };
+
+    uint32_t report_sequence;
+    std::vector<Entry> entries;
+
+    NackHeader() : report_sequence(0) {}
+
+    size_t size() const {
+        return kFixedSize + entries.size() * kEntrySize;
+    }
+
+    // Entries that fit in a datagram of the given size
+    static size_t max_entries(size_t datagram_size) {
+        return datagram_size > kFixedSize ? (datagram_size - kFixedSize) / kEntrySize : 0;
+    }
+
+    void write(uint8_t* out) const {
+        uint16_t entry_count = static_cast<uint16_t>(entries.size());
+        std::memcpy(out, &report_sequence, 4);
+        std::memcpy(out + 4, &entry_count, 2);
+        std::memset(out + 6, 0, 4);
+        out[10] = PACKET_NACK;
+        out[11] = 0;
+
+        uint8_t* p = out + kFixedSize;
+        for (const auto& entry : entries) {
+            std::memcpy(p, &entry.sequence_number, 4);
+            std::memcpy(p + 4, &entry.chunk_id, 2);
+            p += kEntrySize;
+        }
+    }
+
+    static bool parse(const uint8_t* in, size_t size, NackHeader& header) {
+        if (size < kFixedSize || in[kPacketTypeOffset] != PACKET_NACK) {
+            return false;
+        }
+        uint16_t entry_count;
+        std::memcpy(&header.report_sequence, in, 4);
+        std::memcpy(&entry_count, in + 4, 2);
+        if (size < kFixedSize + static_cast<size_t>(entry_count) * kEntrySize) {
+            return false;
+        }
+
+        const uint8_t* p = in + kFixedSize;
+        header.entries.resize(entry_count);
+        for (auto& entry : header.entries) {
+            std::memcpy(&entry.sequence_number, p, 4);
+            std::memcpy(&entry.chunk_id, p + 4, 2);
+            p += kEntrySize;
+        }
+        return true;
+    }
+};
+
+// Keyframe request (like RTCP PLI): 12 bytes. The receiver lost a reference
+// and asks the encoder for an IDR instead of waiting for the next one.
+// - request_sequence (4 bytes): counts requests; copies sent on several
+//   paths share one number
+// - last_sequence (4 bytes): newest frame the receiver has seen
+// - reserved (2 bytes)
+// - packet type (1 byte, PACKET_KEYFRAME_REQUEST)
+// - reserved (1 byte)
+struct KeyframeRequestHeader {
+    static constexpr size_t kSize = 12;
+
+    uint32_t request_sequence;
+    uint32_t last_sequence;
+
+    KeyframeRequestHeader() : request_sequence(0), last_sequence(0) {}
+
+    void write(uint8_t* out) const {
+        std::memcpy(out, &request_sequence, 4);
+        std::memcpy(out + 4, &last_sequence, 4);
+        out[8] = 0;
+        out[9] = 0;
+        out[10] = PACKET_KEYFRAME_REQUEST;
+        out[11] = 0;
+    }
+
+    static bool parse(const uint8_t* in, size_t size, KeyframeRequestHeader& header) {
+        if (size < kSize || in[kPacketTypeOffset] != PACKET_KEYFRAME_REQUEST) {
+            return false;
+        }
+        std::memcpy(&header.request_sequence, in, 4);
+        std::memcpy(&header.last_sequence, in + 4, 4);
+        return true;
+    }
+};
+
+// Identity under which a media packet is acknowledged in feedback: its frame
+// (or interleaved block base) sequence number and a per-frame id. Data chunks
+// use their chunk id; parity sets the top bit over its position in the frame.
+// Retransmissions have none: the sender matched the first copy's send time.
+inline bool feedback_packet_id(const uint8_t* data, size_t size,
+                               uint32_t& sequence_number, uint16_t& packet_id) {
+    PacketType type;
+    if (!peek_packet_type(data, size, type)) {
+        return false;
+    }
+    std::memcpy(&sequence_number, data, 4);
+    if (type == PACKET_DATA && size >= DataHeader::kSize) {
+        std::memcpy(&packet_id, data + 4, 2);
+        return (data[DataHeader::kFlagsOffset] & DataHeader::kFlagRetransmission) == 0;
+    }
+    if (type == PACKET_FEC && size >= FecHeader::kSize) {
+        uint16_t block_id;
+        std::memcpy(&block_id, data + 4, 2);
+        packet_id = static_cast<uint16_t>(0x8000 | ((block_id * 256u + data[11]) & 0x7FFF));
+        return true;
+    }
+    if (type == PACKET_FEC_INTERLEAVED && size >= InterleavedFecHeader::kFixedSize) {
+        uint16_t block_id;
+        std::memcpy(&block_id, data + 4, 2);
+        packet_id = static_cast<uint16_t>(0x8000 | ((block_id * 256u + data[11]) & 0x7FFF));
+        return true;
+    }
+    return false;
+}
+
+// Largest header in front of a chunk-sized payload when FEC blocks have at
+// most max_k data symbols and interleaved blocks span at most
+// interleave_depth frames (1 = per-frame FEC only)
+inline size_t max_packet_header_size(int max_k, int interleave_depth) {
+    size_t size = FecHeader::kSize > DataHeader::kSize ? FecHeader::kSize : DataHeader::kSize;
+    if (interleave_depth > 1) {
+        size_t frames = static_cast<size_t>(interleave_depth < max_k ? interleave_depth : max_k);
+        size_t interleaved = InterleavedFecHeader::kFixedSize +
+                             frames * InterleavedFecHeader::kFrameEntrySize +
+                             static_cast<size_t>(max_k) * InterleavedFecHeader::kMemberEntrySize;
+        size = interleaved > size ? interleaved : size;
+    }
+    return size;
+}
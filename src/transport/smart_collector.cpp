@@ -1,16 +1,45 @@
 // smart_collector.cpp
 #include "smart_collector.h"
+#include "../media/erasure_coder.h"
 #include "../common/logger.h"
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <stdexcept>
 
+namespace {
+
+// Annex B start code at the front of a chunk; emulation prevention keeps
+// 00 00 01 out of NAL payloads, so this marks a NAL unit boundary
+bool starts_nal_unit(ConstByteSpan chunk) {
+    const uint8_t* data = chunk.data;
+    size_t size = chunk.size;
+    if (size >= 3 && data[0] == 0 && data[1] == 0 && data[2] == 1) {
+        return true;
+    }
+    return size >= 4 && data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 1;
+}
+
+} // namespace
+
 SmartCollector::SmartCollector(uint32_t jitter_buffer_ms)
-    : jitter_buffer_ms_(jitter_buffer_ms), running_(false) {
+    : jitter_buffer_ms_(jitter_buffer_ms), max_chunk_size_(1000), running_(false),
+      frame_slots_(kFrameSlots), active_frames_(0), have_newest_sequence_(false), newest_sequence_(0),
+      ready_frames_(kReadyFrameCapacity), dropped_frames_(0), slice_streaming_(false),
+      streaming_active_(false), streaming_sequence_(0), have_next_sequence_(false),
+      next_sequence_(0), reorder_window_ms_(0), held_frames_(0), adaptive_playout_(false),
+      nack_enabled_(false), retransmitted_chunks_(0), interleaved_slots_(kInterleavedSlots),
+      recovered_chunks_(0), duplicate_chunks_(0),
+      recovery_scratch_(kMaxFecSymbols) {
     
     if (jitter_buffer_ms == 0) {
         throw std::invalid_argument("Jitter buffer süresi 0 olamaz");
     }
+    
+    recovery_members_.reserve(kMaxFecSymbols);
+    recovery_missing_.reserve(kMaxFecSymbols);
+    recovery_symbols_.reserve(kMaxFecSymbols);
+    recovery_erasures_.reserve(kMaxFecSymbols);
 }
 
 SmartCollector::~SmartCollector() {
@@ -34,7 +63,12 @@ void SmartCollector::stop() {
         return;
     }
     
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(chunks_mutex_);
+        running_ = false;
+    }
+    stop_cv_.notify_all();
+    ready_frames_.wake();
     
     if (collector_thread_.joinable()) {
         collector_thread_.join();
@@ -43,33 +77,128 @@ void SmartCollector::stop() {
     LOG_INFO("SmartCollector durduruldu");
 }
 
+void SmartCollector::set_max_chunk_size(size_t max_chunk_size) {
+    if (max_chunk_size == 0) {
+        throw std::invalid_argument("Max chunk boyutu 0 olamaz");
+    }
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    max_chunk_size_ = max_chunk_size;
+}
+
+void SmartCollector::set_slice_streaming(bool enabled) {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    slice_streaming_ = enabled;
+}
+
+void SmartCollector::set_reorder_window(uint32_t window_ms) {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    reorder_window_ms_ = window_ms;
+}
+
+void SmartCollector::set_adaptive_playout(bool enabled, uint32_t min_delay_ms) {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    JitterEstimator::Config config;
+    config.min_delay_ms = std::min(min_delay_ms, jitter_buffer_ms_);
+    config.max_delay_ms = jitter_buffer_ms_;
+    jitter_estimator_ = JitterEstimator(config);
+    adaptive_playout_ = enabled;
+}
+
+void SmartCollector::set_nack(bool enabled, uint32_t reorder_delay_ms) {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    NackGenerator::Config config;
+    config.reorder_delay_ms = reorder_delay_ms;
+    nack_generator_ = NackGenerator(config);
+    nack_enabled_ = enabled;
+}
+
+double SmartCollector::get_target_delay_ms() const {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    return adaptive_playout_ ? jitter_estimator_.get_target_delay_ms() : 0.0;
+}
+
+double SmartCollector::get_jitter_ms() const {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    return jitter_estimator_.get_jitter_ms();
+}
+
 void SmartCollector::add_chunk(uint32_t sequence_number, uint16_t chunk_id, 
                               uint16_t total_chunks, const std::vector<uint8_t>& chunk_data) {
-    if (!running_.load()) {
+    DataHeader header;
+    header.sequence_number = sequence_number;
+    header.chunk_id = chunk_id;
+    header.total_chunks = total_chunks;
+    insert_chunk(header, false, ConstByteSpan(chunk_data));
+}
+
+void SmartCollector::add_chunk(uint32_t sequence_number, uint16_t chunk_id,
+                              uint16_t total_chunks, PacketRef chunk) {
+    DataHeader header;
+    header.sequence_number = sequence_number;
+    header.chunk_id = chunk_id;
+    header.total_chunks = total_chunks;
+    insert_chunk(header, false, chunk.span());
+}
+
+void SmartCollector::add_chunk(const DataHeader& header, PacketRef chunk) {
+    insert_chunk(header, true, chunk.span());
+}
+
+void SmartCollector::insert_chunk(const DataHeader& header, bool has_timestamp, ConstByteSpan chunk) {
+    if (!running_.load() || chunk.empty()) {
         return;
     }
     
+    const uint32_t sequence_number = header.sequence_number;
+    const uint16_t chunk_id = header.chunk_id;
+    const uint16_t total_chunks = header.total_chunks;
+    
     try {
         std::lock_guard<std::mutex> lock(chunks_mutex_);
         
+        // A resend dates the NACK that asked for it, even if it comes too late
+        if (nack_enabled_ && header.is_retransmission()) {
+            nack_generator_.on_retransmission(sequence_number, chunk_id, std::chrono::steady_clock::now());
+        }
+        
+        // A chunk that does not fit its place would corrupt its neighbours
+        if (chunk_id >= total_chunks || chunk.size > max_chunk_size_) {
+            return;
+        }
+        
         // Find or create frame buffer for this sequence
-        auto it = frame_buffers_.find(sequence_number);
-        if (it == frame_buffers_.end()) {
-            // Create new frame buffer
-            frame_buffers_[sequence_number] = std::make_unique<FrameBuffer>(total_chunks);
+        FrameBuffer* frame_buffer = get_frame_buffer(sequence_number, total_chunks);
+        if (!frame_buffer) {
+            return;
         }
         
-        FrameBuffer& frame_buffer = *it->second;
+        // A chunk already received, or rebuilt from FEC, must not be counted
+        // a second time; otherwise a duplicate could complete a frame that
+        // still has a hole
+        if (frame_buffer->has_chunk(chunk_id)) {
+            duplicate_chunks_++;
+            return;
+        }
+        if (frame_buffer->complete) {
+            return;
+        }
+        if (has_timestamp && !frame_buffer->has_capture_timestamp) {
+            frame_buffer->has_capture_timestamp = true;
+            frame_buffer->capture_timestamp = header.timestamp;
+        }
+        if (header.is_retransmission()) {
+            retransmitted_chunks_++;
+        }
         
-        // Add chunk to frame buffer
-        if (chunk_id < total_chunks) {
-            frame_buffer.chunks[chunk_id] = chunk_data;
-            frame_buffer.received_chunks++;
-            
-            // Check if frame is complete
-            if (frame_buffer.received_chunks == total_chunks) {
-                complete_frames_.push_back(sequence_number);
-            }
+        frame_buffer->set_chunk(chunk_id, chunk);
+        check_complete(sequence_number, *frame_buffer);
+        
+        // A new data chunk may complete k of k+r for its FEC block
+        if (frame_buffer->fec_k > 0) {
+            try_recover(sequence_number, *frame_buffer, chunk_id / frame_buffer->fec_k);
+        }
+        for (size_t i = 0; i < frame_buffer->interleaved_blocks.size() && !frame_buffer->complete; ++i) {
+            try_recover_interleaved(frame_buffer->interleaved_blocks[i]);
         }
         
     } catch (const std::exception& e) {
@@ -77,41 +206,681 @@ void SmartCollector::add_chunk(uint32_t sequence_number, uint16_t chunk_id,
     }
 }
 
-std::vector<std::vector<uint8_t>> SmartCollector::get_complete_frames() {
-    std::vector<std::vector<uint8_t>> frames;
+void SmartCollector::add_fec_chunk(const FecHeader& header, const uint8_t* payload,
+                                   size_t payload_size) {
+    add_fec_chunk(header, PacketRef::copy_of(ConstByteSpan(payload, payload_size)));
+}
+
+void SmartCollector::add_fec_chunk(const FecHeader& header, PacketRef payload) {
+    if (!running_.load()) {
+        return;
+    }
+    
+    if (header.k == 0 || header.r == 0 || header.index < header.k ||
+        header.index >= header.k + header.r || header.symbol_size == 0 ||
+        payload.size() != header.symbol_size) {
+        return;
+    }
+    
+    try {
+        std::lock_guard<std::mutex> lock(chunks_mutex_);
+        
+        FrameBuffer* frame_buffer = get_frame_buffer(header.sequence_number, header.total_chunks);
+        if (!frame_buffer || frame_buffer->complete) {
+            return;
+        }
+        
+        // FEC parameters must agree across all parity chunks of a frame
+        if (frame_buffer->fec_k == 0) {
+            frame_buffer->fec_k = header.k;
+            frame_buffer->fec_r = header.r;
+            frame_buffer->symbol_size = header.symbol_size;
+            frame_buffer->frame_length = header.frame_length;
+            frame_buffer->fec_block_count = (frame_buffer->total_chunks() + header.k - 1) / header.k;
+            if (frame_buffer->fec_blocks.size() < frame_buffer->fec_block_count) {
+                frame_buffer->fec_blocks.resize(frame_buffer->fec_block_count);
+            }
+            for (size_t i = 0; i < frame_buffer->fec_block_count; ++i) {
+                frame_buffer->fec_blocks[i].reset(header.r);
+            }
+        } else if (frame_buffer->fec_k != header.k || frame_buffer->fec_r != header.r ||
+                   frame_buffer->symbol_size != header.symbol_size) {
+            return;
+        }
+        if (header.block_id >= frame_buffer->fec_block_count) {
+            return;
+        }
+        
+        FecBlock& block = frame_buffer->fec_blocks[header.block_id];
+        auto& parity = block.parity[header.index - header.k];
+        if (parity.empty()) {
+            parity = std::move(payload);
+            block.received_parity++;
+        }
+        
+        try_recover(header.sequence_number, *frame_buffer, header.block_id);
+        
+    } catch (const std::exception& e) {
+        LOG_ERROR("FEC chunk ekleme hatası: " + std::string(e.what()));
+    }
+}
+
+void SmartCollector::add_interleaved_fec_chunk(const InterleavedFecHeader& header,
+                                               const uint8_t* payload, size_t payload_size) {
+    add_interleaved_fec_chunk(header, PacketRef::copy_of(ConstByteSpan(payload, payload_size)));
+}
+
+void SmartCollector::add_interleaved_fec_chunk(const InterleavedFecHeader& header,
+                                               PacketRef payload) {
+    if (!running_.load()) {
+        return;
+    }
+    
+    if (header.k == 0 || header.r == 0 || header.index < header.k ||
+        header.index >= header.k + header.r || header.symbol_size == 0 ||
+        header.members.empty() || header.members.size() > header.k ||
+        payload.size() != header.symbol_size) {
+        return;
+    }
     
     try {
         std::lock_guard<std::mutex> lock(chunks_mutex_);
         
-        // Process complete frames
-        for (uint32_t sequence_number : complete_frames_) {
-            auto it = frame_buffers_.find(sequence_number);
-            if (it != frame_buffers_.end()) {
-                FrameBuffer& frame_buffer = *it->second;
-                
-                // Combine all chunks
-                std::vector<uint8_t> frame_data;
-                for (const auto& chunk : frame_buffer.chunks) {
-                    if (!chunk.empty()) {
-                        frame_data.insert(frame_data.end(), chunk.begin(), chunk.end());
-                    }
+        BlockKey key(header.base_sequence, header.block_id);
+        InterleavedBlock* interleaved = find_interleaved_block(key);
+        if (!interleaved) {
+            // The slot still holds a block a whole ring older, which is long
+            // past any deadline; a block older than the slot's is stale
+            InterleavedBlock& slot = interleaved_slots_[header.block_id % kInterleavedSlots];
+            if (slot.in_use && static_cast<int32_t>(header.base_sequence - slot.header.base_sequence) < 0) {
+                return;
+            }
+            slot.reset(header);
+            interleaved = &slot;
+            
+            // Register the block with every frame it covers; frames that lost
+            // all their data chunks are created here
+            for (const auto& entry : header.frames) {
+                FrameBuffer* frame_buffer = get_frame_buffer(entry.sequence_number, entry.total_chunks);
+                if (!frame_buffer) {
+                    continue;
                 }
-                
-                if (!frame_data.empty()) {
-                    frames.push_back(std::move(frame_data));
+                if (frame_buffer->frame_length == 0) {
+                    frame_buffer->frame_length = entry.frame_length;
                 }
-                
-                // Remove processed frame
-                frame_buffers_.erase(it);
+                frame_buffer->interleaved_blocks.push_back(key);
             }
         }
         
-        complete_frames_.clear();
+        // Parity must agree with the block's first header
+        if (interleaved->header.k != header.k || interleaved->header.r != header.r ||
+            interleaved->header.symbol_size != header.symbol_size) {
+            return;
+        }
+        
+        FecBlock& block = interleaved->parity;
+        auto& parity = block.parity[header.index - header.k];
+        if (parity.empty()) {
+            parity = std::move(payload);
+            block.received_parity++;
+        }
+        
+        try_recover_interleaved(key);
         
     } catch (const std::exception& e) {
-        LOG_ERROR("Frame alma hatası: " + std::string(e.what()));
+        LOG_ERROR("Interleaved FEC chunk ekleme hatası: " + std::string(e.what()));
+    }
+}
+
+SmartCollector::FrameBuffer* SmartCollector::get_frame_buffer(uint32_t sequence_number,
+                                                              uint16_t total_chunks) {
+    FrameBuffer& slot = frame_slots_[sequence_number % kFrameSlots];
+    if (slot.in_use && slot.sequence_number == sequence_number) {
+        return slot.total_chunks() == total_chunks ? &slot : nullptr;
+    }
+    if (total_chunks == 0) {
+        return nullptr;
+    }
+    
+    // The slot still holds a frame a whole ring older, which is long past
+    // any deadline; a packet older than the slot's frame is stale
+    if (slot.in_use) {
+        if (static_cast<int32_t>(sequence_number - slot.sequence_number) < 0) {
+            return nullptr;
+        }
+        release_slot(slot);
+    }
+    
+    slot.reset(sequence_number, total_chunks, max_chunk_size_);
+    active_frames_++;
+    if (!have_newest_sequence_ || static_cast<int32_t>(sequence_number - newest_sequence_) > 0) {
+        have_newest_sequence_ = true;
+        newest_sequence_ = sequence_number;
+    }
+    return &slot;
+}
+
+SmartCollector::FrameBuffer* SmartCollector::find_frame(uint32_t sequence_number) {
+    FrameBuffer& slot = frame_slots_[sequence_number % kFrameSlots];
+    return slot.in_use && slot.sequence_number == sequence_number ? &slot : nullptr;
+}
+
+const SmartCollector::FrameBuffer* SmartCollector::oldest_pending_frame(uint32_t before) const {
+    // Frames not handed out yet, from the oldest that may still be played
+    // up to (excluding) before; the scan covers frames in flight, not the
+    // whole ring, once anything has been handed out
+    if (!have_newest_sequence_) {
+        return nullptr;
+    }
+    uint32_t sequence = have_next_sequence_ ? next_sequence_
+                                            : newest_sequence_ - static_cast<uint32_t>(kFrameSlots - 1);
+    for (size_t n = 0; n < kFrameSlots && static_cast<int32_t>(sequence - before) < 0; ++n, ++sequence) {
+        const FrameBuffer& slot = frame_slots_[sequence % kFrameSlots];
+        if (slot.in_use && slot.sequence_number == sequence && !slot.released) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+SmartCollector::FrameBuffer* SmartCollector::oldest_pending_frame(uint32_t before) {
+    return const_cast<FrameBuffer*>(static_cast<const SmartCollector*>(this)->oldest_pending_frame(before));
+}
+
+const SmartCollector::FrameBuffer* SmartCollector::oldest_held_frame() const {
+    // Held frames are never older than next_sequence_, so the walk starts
+    // there and stops at the first one
+    if (held_frames_ == 0 || !have_newest_sequence_) {
+        return nullptr;
+    }
+    uint32_t sequence = have_next_sequence_ ? next_sequence_
+                                            : newest_sequence_ - static_cast<uint32_t>(kFrameSlots - 1);
+    for (size_t n = 0; n < kFrameSlots && static_cast<int32_t>(sequence - newest_sequence_) <= 0;
+         ++n, ++sequence) {
+        const FrameBuffer& slot = frame_slots_[sequence % kFrameSlots];
+        if (slot.in_use && slot.sequence_number == sequence && slot.held) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+SmartCollector::FrameBuffer* SmartCollector::oldest_held_frame() {
+    return const_cast<FrameBuffer*>(static_cast<const SmartCollector*>(this)->oldest_held_frame());
+}
+
+SmartCollector::InterleavedBlock* SmartCollector::find_interleaved_block(const BlockKey& key) {
+    InterleavedBlock& slot = interleaved_slots_[key.second % kInterleavedSlots];
+    return slot.in_use && slot.header.base_sequence == key.first && slot.header.block_id == key.second
+               ? &slot : nullptr;
+}
+
+void SmartCollector::release_slot(FrameBuffer& frame_buffer) {
+    if (streaming_active_ && streaming_sequence_ == frame_buffer.sequence_number) {
+        streaming_active_ = false;
+    }
+    if (frame_buffer.held) {
+        frame_buffer.held = false;
+        held_frames_--;
+        dropped_frames_++;
+    }
+    frame_buffer.clear();
+    active_frames_--;
+}
+
+void SmartCollector::check_complete(uint32_t sequence_number, FrameBuffer& frame_buffer) {
+    if (frame_buffer.complete) {
+        return;
+    }
+    if (frame_buffer.received_chunks != frame_buffer.total_chunks()) {
+        if (slice_streaming_) {
+            forward_prefix(sequence_number, frame_buffer);
+        }
+        return;
+    }
+    frame_buffer.complete = true;
+    const size_t first = frame_buffer.forwarded_chunks;
+    
+    // Keep the chunks until cleanup; interleaved parity that arrives later
+    // may still need them to rebuild other frames
+    frame_buffer.released = true;
+    
+    auto now = std::chrono::steady_clock::now();
+    if (adaptive_playout_ && frame_buffer.has_capture_timestamp) {
+        jitter_estimator_.on_frame(frame_buffer.capture_timestamp, now);
+    }
+    release_held_frames();
+    
+    // Ahead of a frame not handed out yet, or of the one being streamed:
+    // the older frame may still be on its way over a slower path
+    bool out_of_order =
+        (have_next_sequence_ && static_cast<int32_t>(sequence_number - next_sequence_) > 0) ||
+        (streaming_active_ && static_cast<int32_t>(sequence_number - streaming_sequence_) > 0);
+    
+    // On the playout clock a frame waits for its playout time, and older
+    // frames are waited for until then; otherwise out of order frames wait
+    // up to the reorder window. A frame older than one already handed out
+    // is late either way and goes straight out.
+    auto due = now;
+    auto deadline = now + std::chrono::milliseconds(reorder_window_ms_);
+    std::chrono::steady_clock::time_point playout;
+    if (first == 0 && playout_time(frame_buffer, playout)) {
+        due = playout;
+        deadline = playout;
+    }
+    const FrameBuffer* oldest_held = oldest_held_frame();
+    bool behind_held = oldest_held &&
+                       static_cast<int32_t>(oldest_held->sequence_number - sequence_number) < 0;
+    bool late = have_next_sequence_ && static_cast<int32_t>(sequence_number - next_sequence_) < 0;
+    if (!late && (due > now || behind_held || (out_of_order && deadline > now))) {
+        frame_buffer.held = true;
+        frame_buffer.held_due = due;
+        frame_buffer.held_deadline = deadline;
+        held_frames_++;
+        stop_cv_.notify_all();
+        return;
+    }
+    
+    release_frame(frame_buffer.unforwarded());
+    release_held_frames();
+}
+
+bool SmartCollector::playout_time(const FrameBuffer& frame_buffer,
+                                  std::chrono::steady_clock::time_point& playout) const {
+    if (!adaptive_playout_ || !frame_buffer.has_capture_timestamp || !jitter_estimator_.has_estimate()) {
+        return false;
+    }
+    playout = jitter_estimator_.playout_time(frame_buffer.capture_timestamp);
+    return true;
+}
+
+std::chrono::steady_clock::time_point SmartCollector::frame_deadline(const FrameBuffer& frame_buffer) const {
+    // Played at its playout time, or given up by cleanup a jitter buffer
+    // after its first packet
+    std::chrono::steady_clock::time_point playout;
+    if (playout_time(frame_buffer, playout)) {
+        return playout;
+    }
+    return frame_buffer.timestamp + std::chrono::milliseconds(jitter_buffer_ms_);
+}
+
+bool SmartCollector::collect_nacks(std::chrono::steady_clock::time_point now,
+                                   std::vector<NackHeader::Entry>& entries, size_t max_entries) {
+    entries.clear();
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    if (!nack_enabled_ || !have_newest_sequence_) {
+        return false;
+    }
+    
+    // Frames not handed out yet, oldest first. A sequence number with no
+    // frame is a lost frame only after one handed out or between received
+    // ones, and is due by the deadline of the next frame received.
+    uint32_t sequence = have_next_sequence_ ? next_sequence_
+                                            : newest_sequence_ - static_cast<uint32_t>(kFrameSlots - 1);
+    nack_generator_.prune(sequence);
+    bool have_gap_start = false;
+    uint32_t gap_start = 0;
+    bool seen = have_next_sequence_;
+    
+    for (size_t n = 0; n < kFrameSlots && static_cast<int32_t>(sequence - newest_sequence_) <= 0 &&
+                       entries.size() < max_entries; ++n, ++sequence) {
+        const FrameBuffer* frame_buffer = find_frame(sequence);
+        if (!frame_buffer) {
+            if (seen && !have_gap_start) {
+                have_gap_start = true;
+                gap_start = sequence;
+            }
+            continue;
+        }
+        seen = true;
+        
+        const auto deadline = frame_deadline(*frame_buffer);
+        for (; have_gap_start && gap_start != sequence && entries.size() < max_entries; ++gap_start) {
+            if (nack_generator_.on_missing(gap_start, NackHeader::kWholeFrame, deadline, now)) {
+                entries.push_back({gap_start, NackHeader::kWholeFrame});
+            }
+        }
+        have_gap_start = false;
+        if (frame_buffer->released) {
+            continue;
+        }
+        
+        // Chunks are sent in order: those before the last one received were
+        // sent, and the newest frame's tail may still be on its way
+        size_t end = frame_buffer->total_chunks();
+        if (sequence == newest_sequence_) {
+            end = 0;
+            for (size_t word = frame_buffer->received.size(); word-- > 0;) {
+                if (frame_buffer->received[word] != 0) {
+                    end = word * 64 + 63 - __builtin_clzll(frame_buffer->received[word]);
+                    break;
+                }
+            }
+        }
+        for (size_t chunk_id = frame_buffer->forwarded_chunks; chunk_id < end && entries.size() < max_entries;
+             ++chunk_id) {
+            if (!frame_buffer->has_chunk(chunk_id) &&
+                nack_generator_.on_missing(sequence, static_cast<uint16_t>(chunk_id), deadline, now)) {
+                entries.push_back({sequence, static_cast<uint16_t>(chunk_id)});
+            }
+        }
+    }
+    return !entries.empty();
+}
+
+void SmartCollector::release_frame(CompleteFrame&& frame) {
+    const uint32_t sequence_number = frame.sequence_number;
+    if (!frame.data.empty() && !ready_frames_.try_push(std::move(frame))) {
+        dropped_frames_++;
+        LOG_WARNING("Hazır frame kuyruğu dolu, frame atıldı: " + std::to_string(sequence_number));
+    }
+    
+    if (!have_next_sequence_ || static_cast<int32_t>(sequence_number + 1 - next_sequence_) > 0) {
+        have_next_sequence_ = true;
+        next_sequence_ = sequence_number + 1;
     }
     
+    // A streamed frame that is now older than a finished one is given up
+    if (streaming_active_ && static_cast<int32_t>(sequence_number - streaming_sequence_) >= 0) {
+        end_stream(streaming_sequence_);
+        start_next_stream();
+    }
+}
+
+void SmartCollector::release_held_frames() {
+    // Held frames go out in sequence once due: when next in line, or at
+    // their deadline even if older frames are still missing, which are then
+    // given up
+    auto now = std::chrono::steady_clock::now();
+    bool released = false;
+    FrameBuffer* held;
+    while ((held = oldest_held_frame()) != nullptr) {
+        bool in_order = !streaming_active_ &&
+                        (!have_next_sequence_ || held->sequence_number == next_sequence_);
+        if (now < held->held_due || (!in_order && now < held->held_deadline)) {
+            break;
+        }
+        held->held = false;
+        held_frames_--;
+        release_frame(held->unforwarded());
+        released = true;
+    }
+    
+    // The frame after them may already hold a decodable prefix
+    if (released) {
+        start_next_stream();
+    }
+}
+
+void SmartCollector::forward_prefix(uint32_t sequence_number, FrameBuffer& frame_buffer) {
+    if (streaming_active_) {
+        if (streaming_sequence_ != sequence_number) {
+            return;
+        }
+    } else {
+        // Only the oldest pending frame newer than everything handed out
+        if (have_next_sequence_ && static_cast<int32_t>(sequence_number - next_sequence_) < 0) {
+            return;
+        }
+        if (oldest_pending_frame(sequence_number)) {
+            return;
+        }
+        
+        // Nor past a complete frame held for an older one
+        const FrameBuffer* oldest_held = oldest_held_frame();
+        if (oldest_held && static_cast<int32_t>(oldest_held->sequence_number - sequence_number) < 0) {
+            return;
+        }
+        
+        // Nor, even in part, before its playout time
+        std::chrono::steady_clock::time_point playout;
+        if (playout_time(frame_buffer, playout) && playout > std::chrono::steady_clock::now()) {
+            return;
+        }
+    }
+    
+    const size_t first = frame_buffer.forwarded_chunks;
+    if (first == 0 && (!frame_buffer.has_chunk(0) || !starts_nal_unit(frame_buffer.chunk(0)))) {
+        return;
+    }
+    
+    // Run of received chunks; the chunk after it is missing, so the run is
+    // cut back to the last chunk that starts a NAL unit
+    size_t end = first;
+    while (end < frame_buffer.total_chunks() && frame_buffer.has_chunk(end)) {
+        end++;
+    }
+    if (end <= first + 1) {
+        return;
+    }
+    size_t cut = end - 1;
+    while (cut > first && !starts_nal_unit(frame_buffer.chunk(cut))) {
+        cut--;
+    }
+    if (cut == first) {
+        return;
+    }
+    
+    // The padding between the run's chunks is harmless zeros in Annex B.
+    // Later chunks are written past the run while the consumer reads it.
+    CompleteFrame piece;
+    piece.sequence_number = sequence_number;
+    piece.frame_start = first == 0;
+    piece.frame_end = false;
+    piece.data = frame_buffer.payload.subview(first * frame_buffer.stride,
+                                              (cut - first) * frame_buffer.stride);
+    
+    if (!ready_frames_.try_push(std::move(piece))) {
+        dropped_frames_++;
+        LOG_WARNING("Hazır frame kuyruğu dolu, frame atıldı: " + std::to_string(sequence_number));
+        end_stream(sequence_number);
+        return;
+    }
+    
+    frame_buffer.forwarded_chunks = static_cast<uint16_t>(cut);
+    streaming_active_ = true;
+    streaming_sequence_ = sequence_number;
+    if (!have_next_sequence_ || static_cast<int32_t>(sequence_number + 1 - next_sequence_) > 0) {
+        have_next_sequence_ = true;
+        next_sequence_ = sequence_number + 1;
+    }
+}
+
+void SmartCollector::end_stream(uint32_t sequence_number) {
+    streaming_active_ = false;
+    
+    // A frame left unfinished is abandoned; the consumer sees the next
+    // frame start before its end and treats it as lost
+    FrameBuffer* frame_buffer = find_frame(sequence_number);
+    if (frame_buffer && !frame_buffer->complete) {
+        frame_buffer->complete = true;
+        frame_buffer->released = true;
+    }
+}
+
+void SmartCollector::start_next_stream() {
+    if (!slice_streaming_ || streaming_active_) {
+        return;
+    }
+    
+    // The oldest pending frame may already hold a decodable prefix
+    FrameBuffer* oldest = have_newest_sequence_ ? oldest_pending_frame(newest_sequence_ + 1) : nullptr;
+    if (oldest) {
+        forward_prefix(oldest->sequence_number, *oldest);
+    }
+}
+
+void SmartCollector::try_recover(uint32_t sequence_number, FrameBuffer& frame_buffer,
+                                 uint16_t block_id) {
+    if (frame_buffer.complete || frame_buffer.fec_k == 0) {
+        return;
+    }
+    
+    if (block_id >= frame_buffer.fec_block_count) {
+        return;
+    }
+    
+    const int k = frame_buffer.fec_k;
+    const size_t total_chunks = frame_buffer.total_chunks();
+    const size_t first_chunk = static_cast<size_t>(block_id) * k;
+    if (first_chunk >= total_chunks) {
+        return;
+    }
+    const size_t last_chunk = std::min<size_t>(first_chunk + k, total_chunks);
+    
+    recovery_members_.clear();
+    for (size_t chunk_id = first_chunk; chunk_id < last_chunk; ++chunk_id) {
+        recovery_members_.push_back({sequence_number, &frame_buffer, static_cast<uint16_t>(chunk_id)});
+    }
+    
+    recover_symbols(recovery_members_, k, frame_buffer.fec_r, frame_buffer.symbol_size,
+                    frame_buffer.fec_blocks[block_id]);
+}
+
+void SmartCollector::try_recover_interleaved(const BlockKey& key) {
+    InterleavedBlock* block = find_interleaved_block(key);
+    if (!block) {
+        return;
+    }
+    const InterleavedFecHeader& header = block->header;
+    
+    recovery_members_.clear();
+    for (const auto& member : header.members) {
+        uint32_t sequence_number = header.frames[member.frame_index].sequence_number;
+        FrameBuffer* frame = find_frame(sequence_number);
+        if (frame && member.chunk_id >= frame->total_chunks()) {
+            return;
+        }
+        recovery_members_.push_back({sequence_number, frame, member.chunk_id});
+    }
+    
+    recover_symbols(recovery_members_, header.k, header.r, header.symbol_size, block->parity);
+}
+
+void SmartCollector::recover_symbols(const std::vector<SymbolRef>& members, int k, int r,
+                                     size_t symbol_size, FecBlock& block) {
+    // Columns to rebuild, and unknown columns whose frame is already gone
+    std::vector<int>& missing = recovery_missing_;
+    missing.clear();
+    int unknown = 0;
+    for (size_t j = 0; j < members.size(); ++j) {
+        const SymbolRef& ref = members[j];
+        if (!ref.frame) {
+            unknown++;
+        } else if (!ref.frame->has_chunk(ref.chunk_id)) {
+            missing.push_back(static_cast<int>(j));
+        }
+    }
+    if (missing.empty() ||
+        static_cast<int>(missing.size()) + unknown > block.received_parity) {
+        return;
+    }
+    
+    ErasureCoder* coder = get_coder(k, r);
+    if (!coder) {
+        return;
+    }
+    
+    // A frame's payload is the padded byte image FEC protects, so when
+    // symbols are one chunk stride long they are read and rebuilt in place.
+    // Otherwise, and for columns past the member list, zero padded copies.
+    size_t scratch_used = 0;
+    std::vector<uint8_t*>& symbols = recovery_symbols_;
+    symbols.assign(k + r, nullptr);
+    std::vector<int>& erasures = recovery_erasures_;
+    erasures.clear();
+    
+    for (int j = 0; j < k; ++j) {
+        const SymbolRef* ref = j < static_cast<int>(members.size()) ? &members[j] : nullptr;
+        bool present = ref && ref->frame && ref->frame->has_chunk(ref->chunk_id);
+        if (ref && !present) {
+            erasures.push_back(j);
+        }
+        if (ref && ref->frame && ref->frame->stride == symbol_size) {
+            symbols[j] = ref->frame->chunk_data(ref->chunk_id);
+            continue;
+        }
+        std::vector<uint8_t>& copy = recovery_scratch_[scratch_used++];
+        copy.assign(symbol_size, 0);
+        if (present) {
+            ConstByteSpan chunk = ref->frame->chunk(ref->chunk_id);
+            if (chunk.size > symbol_size) {
+                return;
+            }
+            std::copy(chunk.begin(), chunk.end(), copy.begin());
+        }
+        symbols[j] = copy.data();
+    }
+    
+    for (int i = 0; i < r; ++i) {
+        if (block.parity[i].empty()) {
+            erasures.push_back(k + i);
+        } else {
+            symbols[k + i] = const_cast<uint8_t*>(block.parity[i].data());
+        }
+    }
+    
+    if (!coder->reconstruct(symbols, erasures, symbol_size)) {
+        return;
+    }
+    
+    for (int j : missing) {
+        const SymbolRef& ref = members[j];
+        FrameBuffer& frame_buffer = *ref.frame;
+        size_t total_chunks = frame_buffer.total_chunks();
+        size_t length = symbol_size;
+        
+        // The last chunk of a frame is cut back to the original frame length
+        if (ref.chunk_id == total_chunks - 1) {
+            size_t offset = (total_chunks - 1) * symbol_size;
+            if (frame_buffer.frame_length <= offset ||
+                frame_buffer.frame_length - offset > symbol_size) {
+                continue;
+            }
+            length = frame_buffer.frame_length - offset;
+        }
+        
+        if (length > frame_buffer.stride) {
+            continue;
+        }
+        
+        if (symbols[j] == frame_buffer.chunk_data(ref.chunk_id)) {
+            frame_buffer.mark_chunk(ref.chunk_id, length);
+        } else {
+            frame_buffer.set_chunk(ref.chunk_id, ConstByteSpan(symbols[j], length));
+        }
+        recovered_chunks_++;
+        
+        check_complete(ref.sequence_number, frame_buffer);
+    }
+}
+
+ErasureCoder* SmartCollector::get_coder(int k, int r) {
+    auto key = std::make_pair(k, r);
+    auto it = coders_.find(key);
+    if (it == coders_.end()) {
+        try {
+            auto coder = std::make_unique<ErasureCoder>(ErasureCoder::CodingParams(k, r));
+            it = coders_.emplace(key, std::move(coder)).first;
+        } catch (const std::exception& e) {
+            LOG_WARNING("Geçersiz FEC parametreleri: " + std::string(e.what()));
+            return nullptr;
+        }
+    }
+    return it->second.get();
+}
+
+std::vector<std::vector<uint8_t>> SmartCollector::get_complete_frames() {
+    std::vector<std::vector<uint8_t>> frames;
+    for (auto& frame : pop_complete_frames()) {
+        frames.emplace_back(frame.data.begin(), frame.data.end());
+    }
+    return frames;
+}
+
+std::vector<SmartCollector::CompleteFrame> SmartCollector::pop_complete_frames() {
+    std::vector<CompleteFrame> frames(ready_frames_.size());
+    frames.resize(ready_frames_.try_pop_batch(frames.data(), frames.size()));
     return frames;
 }
 
@@ -133,59 +902,206 @@ void SmartCollector::collector_loop() {
             LOG_ERROR("Collector döngüsü hatası: " + std::string(e.what()));
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // Sleep until the next cleanup or reorder deadline; stop() and
+        // newly held frames wake us early
+        std::unique_lock<std::mutex> lock(chunks_mutex_);
+        if (!running_.load()) {
+            break;
+        }
+        stop_cv_.wait_until(lock, next_wake_time(last_cleanup + cleanup_interval));
+        release_held_frames();
+        start_next_stream();
     }
 }
 
+std::chrono::steady_clock::time_point
+SmartCollector::next_wake_time(std::chrono::steady_clock::time_point limit) const {
+    auto now = std::chrono::steady_clock::now();
+    auto wake = limit;
+    
+    // The oldest held frame decides when the held ones can move
+    if (const FrameBuffer* held = oldest_held_frame()) {
+        wake = std::min(wake, now < held->held_due ? held->held_due : held->held_deadline);
+    }
+    
+    // The next frame to stream may be waiting for its playout time
+    if (slice_streaming_ && !streaming_active_) {
+        const FrameBuffer* oldest = have_newest_sequence_ ? oldest_pending_frame(newest_sequence_ + 1) : nullptr;
+        std::chrono::steady_clock::time_point playout;
+        if (oldest && oldest->received_chunks > 0 && playout_time(*oldest, playout) && playout > now) {
+            wake = std::min(wake, playout);
+        }
+    }
+    
+    return wake;
+}
+
+bool SmartCollector::wait_for_complete_frames(std::chrono::milliseconds timeout) {
+    if (!running_.load()) {
+        return !ready_frames_.empty();
+    }
+    return ready_frames_.wait_for_data(timeout);
+}
+
 void SmartCollector::cleanup_old_frames() {
     std::lock_guard<std::mutex> lock(chunks_mutex_);
     
     auto now = std::chrono::steady_clock::now();
     auto cutoff_time = now - std::chrono::milliseconds(jitter_buffer_ms_);
     
-    // Remove old frame buffers
-    auto it = frame_buffers_.begin();
-    while (it != frame_buffers_.end()) {
-        if (it->second->timestamp < cutoff_time) {
-            it = frame_buffers_.erase(it);
-        } else {
-            ++it;
+    // Free the slots of old frames; held frames go out at their deadline
+    for (auto& slot : frame_slots_) {
+        if (slot.in_use && !slot.held && slot.timestamp < cutoff_time) {
+            release_slot(slot);
         }
     }
     
-    // Remove old complete frames
-    auto frame_it = complete_frames_.begin();
-    while (frame_it != complete_frames_.end()) {
-        auto buffer_it = frame_buffers_.find(*frame_it);
-        if (buffer_it == frame_buffers_.end() || 
-            buffer_it->second->timestamp < cutoff_time) {
-            frame_it = complete_frames_.erase(frame_it);
-        } else {
-            ++frame_it;
+    // Free the slots of old interleaved blocks
+    for (auto& block : interleaved_slots_) {
+        if (block.in_use && block.timestamp < cutoff_time) {
+            block.clear();
         }
     }
+    
+    // A frame that never completed no longer holds back the next one
+    start_next_stream();
+    release_held_frames();
 }
 
 size_t SmartCollector::get_frame_count() const {
     std::lock_guard<std::mutex> lock(chunks_mutex_);
-    return frame_buffers_.size();
+    return active_frames_;
 }
 
 size_t SmartCollector::get_complete_frame_count() const {
-    std::lock_guard<std::mutex> lock(chunks_mutex_);
-    return complete_frames_.size();
+    return ready_frames_.size();
 }
 
 uint32_t SmartCollector::get_jitter_buffer_ms() const {
     return jitter_buffer_ms_;
 }
 
+uint64_t SmartCollector::get_recovered_chunk_count() const {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    return recovered_chunks_;
+}
+
+uint64_t SmartCollector::get_duplicate_chunk_count() const {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    return duplicate_chunks_;
+}
+
+uint64_t SmartCollector::get_nack_request_count() const {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    return nack_generator_.get_request_count();
+}
+
+uint64_t SmartCollector::get_retransmitted_chunk_count() const {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    return retransmitted_chunks_;
+}
+
+double SmartCollector::get_nack_rtt_ms() const {
+    std::lock_guard<std::mutex> lock(chunks_mutex_);
+    return nack_generator_.get_rtt_ms();
+}
+
+uint64_t SmartCollector::get_dropped_frame_count() const {
+    return dropped_frames_.load();
+}
+
 bool SmartCollector::is_running() const {
     return running_.load();
 }
 
+void SmartCollector::FecBlock::reset(uint8_t r) {
+    parity.clear();
+    parity.resize(r);
+    received_parity = 0;
+}
+
 // FrameBuffer constructor
-SmartCollector::FrameBuffer::FrameBuffer(uint16_t total_chunks)
-    : chunks(total_chunks), received_chunks(0), 
-      timestamp(std::chrono::steady_clock::now()) {
+SmartCollector::FrameBuffer::FrameBuffer()
+    : in_use(false), sequence_number(0), stride(0), received_chunks(0), complete(false), released(false),
+      forwarded_chunks(0), has_capture_timestamp(false), capture_timestamp(0), fec_k(0), fec_r(0),
+      symbol_size(0), frame_length(0), fec_block_count(0), held(false) {
+}
+
+void SmartCollector::FrameBuffer::reset(uint32_t sequence, uint16_t total_chunks, size_t chunk_stride) {
+    in_use = true;
+    sequence_number = sequence;
+    stride = chunk_stride;
+    
+    // Refill the previous frame's buffer unless the consumer still reads it
+    const size_t size = static_cast<size_t>(total_chunks) * stride;
+    if (!payload.unique() || payload.capacity() < size) {
+        payload = PacketRef::allocate(size);
+    }
+    payload.resize(size);
+    chunk_sizes.assign(total_chunks, 0);
+    received.assign((total_chunks + 63) / 64, 0);
+    received_chunks = 0;
+    timestamp = std::chrono::steady_clock::now();
+    complete = false;
+    released = false;
+    forwarded_chunks = 0;
+    has_capture_timestamp = false;
+    capture_timestamp = 0;
+    fec_k = 0;
+    fec_r = 0;
+    symbol_size = 0;
+    frame_length = 0;
+    held = false;
+}
+
+void SmartCollector::FrameBuffer::clear() {
+    in_use = false;
+    chunk_sizes.clear();
+    
+    // Parity buffers go back to the pool; the blocks stay for the next frame
+    for (size_t i = 0; i < fec_block_count; ++i) {
+        fec_blocks[i].reset(0);
+    }
+    fec_block_count = 0;
+    interleaved_blocks.clear();
+}
+
+void SmartCollector::FrameBuffer::set_chunk(size_t chunk_id, ConstByteSpan bytes) {
+    uint8_t* place = chunk_data(chunk_id);
+    std::memcpy(place, bytes.data, bytes.size);
+    std::memset(place + bytes.size, 0, stride - bytes.size);
+    mark_chunk(chunk_id, bytes.size);
+}
+
+void SmartCollector::FrameBuffer::mark_chunk(size_t chunk_id, size_t size) {
+    chunk_sizes[chunk_id] = static_cast<uint16_t>(size);
+    received[chunk_id / 64] |= uint64_t(1) << (chunk_id % 64);
+    received_chunks++;
+}
+
+PacketRef SmartCollector::FrameBuffer::view(size_t first) const {
+    const size_t last = total_chunks() - 1;
+    const size_t begin = first * stride;
+    return payload.subview(begin, last * stride + chunk_sizes[last] - begin);
+}
+
+SmartCollector::CompleteFrame SmartCollector::FrameBuffer::unforwarded() const {
+    CompleteFrame frame;
+    frame.sequence_number = sequence_number;
+    frame.frame_start = forwarded_chunks == 0;
+    frame.data = view(forwarded_chunks);
+    return frame;
+}
+
+void SmartCollector::InterleavedBlock::reset(const InterleavedFecHeader& h) {
+    in_use = true;
+    header = h;
+    parity.reset(h.r);
+    timestamp = std::chrono::steady_clock::now();
+}
+
+void SmartCollector::InterleavedBlock::clear() {
+    // Parity buffers go back to the pool; the slot keeps its storage
+    in_use = false;
+    parity.reset(0);
 }
\ No newline at end of file
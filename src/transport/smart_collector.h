@@ -8,9 +8,29 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include "packet_header.h"
+#include "jitter_estimator.h"
+#include "nack_generator.h"
+#include "../common/packet_pool.h"
+#include "../common/ring_buffer.h"
+
+class ErasureCoder;
 
 class SmartCollector {
 public:
+    // A whole frame, or with slice streaming one run of whole NAL units of
+    // it; the runs of a frame are handed out in order. data is a view into
+    // the buffer the frame was assembled in, laid out as the sender's
+    // Slicer::slice_nal_aligned layout (chunk i at i * max chunk size, zero
+    // padded), so no bytes are copied to hand it out.
+    struct CompleteFrame {
+        uint32_t sequence_number = 0;
+        PacketRef data;
+        bool frame_start = true;  // First bytes of the frame
+        bool frame_end = true;    // Last bytes of the frame
+    };
+    
     explicit SmartCollector(uint32_t jitter_buffer_ms);
     ~SmartCollector();
     
@@ -18,37 +38,272 @@ public:
     void start();
     void stop();
     
-    // Add chunk to collector
+    // Sender's max chunk size: chunk i of a frame is written at
+    // i * max_chunk_size, and larger chunks are rejected. Set before start().
+    void set_max_chunk_size(size_t max_chunk_size);
+    
+    // Hand out the decodable prefix of the oldest pending frame as its
+    // chunks arrive instead of waiting for the whole frame. Only frames in
+    // Annex B format are streamed; chunk starts are taken as NAL boundaries
+    // (see Slicer::slice_nal_aligned). Set before start().
+    void set_slice_streaming(bool enabled);
+    
+    // With several paths a frame can complete before an older one whose
+    // packets took a slower path. A frame that completes out of order is
+    // held up to window_ms for the older ones and frames are handed out in
+    // sequence; after that the missing frames are given up. 0 hands frames
+    // out as they complete. Set before start().
+    void set_reorder_window(uint32_t window_ms);
+    
+    // Hand frames out on a playout clock instead of as they complete: a
+    // frame is released at its capture timestamp plus the fastest recent
+    // transit plus a target delay that follows the measured jitter (see
+    // JitterEstimator), between min_delay_ms and the jitter buffer size.
+    // Older frames are waited for until then and given up after. Only
+    // frames added with a DataHeader carry a timestamp. Set before start().
+    void set_adaptive_playout(bool enabled, uint32_t min_delay_ms = 0);
+    
+    // Ask the sender to resend missing data chunks (see NackGenerator): a
+    // chunk is missing once a later chunk of its frame, or a newer frame,
+    // arrived and it stayed missing for reorder_delay_ms. Frames with no
+    // packet at all between received ones are asked for whole. Set before
+    // start().
+    void set_nack(bool enabled, uint32_t reorder_delay_ms = 10);
+    
+    // Missing chunks due for a NACK at now, at most max_entries; returns
+    // false if there are none. Call every few milliseconds.
+    bool collect_nacks(std::chrono::steady_clock::time_point now,
+                       std::vector<NackHeader::Entry>& entries, size_t max_entries);
+    
+    // Add chunk to collector. Its bytes are written in place into the
+    // frame's buffer and the packet is not kept; a chunk already received
+    // (or rebuilt by FEC) is counted as a duplicate and ignored.
+    void add_chunk(uint32_t sequence_number, uint16_t chunk_id,
+                   uint16_t total_chunks, PacketRef chunk);
     void add_chunk(uint32_t sequence_number, uint16_t chunk_id, 
                    uint16_t total_chunks, const std::vector<uint8_t>& chunk_data);
     
-    // Get complete frames
+    // Same, with the frame's capture timestamp for the playout clock
+    void add_chunk(const DataHeader& header, PacketRef chunk);
+    
+    // Add FEC parity chunk. Lost data chunks of its block are rebuilt as soon
+    // as any k of the block's k+r symbols are present, so the frame is
+    // released without waiting for the jitter buffer deadline.
+    void add_fec_chunk(const FecHeader& header, PacketRef payload);
+    void add_fec_chunk(const FecHeader& header, const uint8_t* payload, size_t payload_size);
+    
+    // Add interleaved FEC parity chunk whose block spans several frames
+    void add_interleaved_fec_chunk(const InterleavedFecHeader& header, PacketRef payload);
+    void add_interleaved_fec_chunk(const InterleavedFecHeader& header,
+                                   const uint8_t* payload, size_t payload_size);
+    
+    // Get complete frames. Frames are assembled as they complete and handed
+    // over through a lock-free ring, so this and wait_for_complete_frames()
+    // must be called from a single consumer thread.
     std::vector<std::vector<uint8_t>> get_complete_frames();
     
+    // Same, with the sequence number of each frame for gap detection
+    std::vector<CompleteFrame> pop_complete_frames();
+    
+    // Block until a frame completes, the timeout expires or the collector
+    // stops; returns true if complete frames are waiting
+    bool wait_for_complete_frames(std::chrono::milliseconds timeout);
+    
     // Get statistics
     size_t get_frame_count() const;
     size_t get_complete_frame_count() const;
     uint32_t get_jitter_buffer_ms() const;
+    uint64_t get_recovered_chunk_count() const;
+    uint64_t get_duplicate_chunk_count() const;
+    uint64_t get_nack_request_count() const;
+    uint64_t get_retransmitted_chunk_count() const;  // retransmissions that filled a gap
+    double get_nack_rtt_ms() const;
+    uint64_t get_dropped_frame_count() const;
+    double get_target_delay_ms() const;  // 0 without adaptive playout
+    double get_jitter_ms() const;
     bool is_running() const;
 
 private:
+    struct FecBlock {
+        std::vector<PacketRef> parity;  // r entries, empty if missing
+        uint16_t received_parity;
+        
+        explicit FecBlock(uint8_t r = 0) : parity(r), received_parity(0) {}
+        
+        // Start over for another block; storage is kept
+        void reset(uint8_t r);
+    };
+    
+    // One slot of the frame ring. Slots are reset in place for the next
+    // frame that maps to them, so their arrays keep their capacity and a
+    // frame costs no allocation once the ring has warmed up. The payload
+    // buffer is reused too unless the consumer still holds a view of it.
     struct FrameBuffer {
-        std::vector<std::vector<uint8_t>> chunks;
+        bool in_use;
+        uint32_t sequence_number;
+        size_t stride;                     // bytes per chunk in payload
+        PacketRef payload;                 // chunk i at i * stride, zero padded
+        std::vector<uint16_t> chunk_sizes;
+        std::vector<uint64_t> received;    // bitmap over chunks
         uint16_t received_chunks;
         std::chrono::steady_clock::time_point timestamp;
+        bool complete;
+        bool released;  // handed out; chunks kept as known symbols for interleaved FEC
+        uint16_t forwarded_chunks;  // Prefix already handed out by slice streaming
+        bool has_capture_timestamp;
+        uint32_t capture_timestamp;  // 90 kHz sender clock
+        
+        // FEC parameters, known once the first parity chunk arrives
+        uint8_t fec_k;
+        uint8_t fec_r;
+        size_t symbol_size;
+        uint32_t frame_length;
+        std::vector<FecBlock> fec_blocks;  // by block id; only grows, the first fec_block_count are used
+        size_t fec_block_count;            // blocks of this frame, set once k is known
+        
+        // Interleaved blocks (base sequence, block id) with a member in this frame
+        std::vector<std::pair<uint32_t, uint16_t>> interleaved_blocks;
+        
+        // Complete, waiting for its playout time or for older frames
+        bool held;
+        std::chrono::steady_clock::time_point held_due;       // earliest release
+        std::chrono::steady_clock::time_point held_deadline;  // release even if older frames are missing
+        
+        FrameBuffer();
+        
+        // Take the slot for a new frame, or give it up
+        void reset(uint32_t sequence, uint16_t total_chunks, size_t chunk_stride);
+        void clear();
+        
+        size_t total_chunks() const { return chunk_sizes.size(); }
+        bool has_chunk(size_t chunk_id) const {
+            return (received[chunk_id / 64] >> (chunk_id % 64)) & 1;
+        }
+        uint8_t* chunk_data(size_t chunk_id) { return payload.mutable_data() + chunk_id * stride; }
+        ConstByteSpan chunk(size_t chunk_id) const {
+            return ConstByteSpan(payload.data() + chunk_id * stride, chunk_sizes[chunk_id]);
+        }
+        
+        // Copy a chunk into place, padding it to the stride
+        void set_chunk(size_t chunk_id, ConstByteSpan bytes);
+        
+        // Record a chunk whose bytes are already in place
+        void mark_chunk(size_t chunk_id, size_t size);
+        
+        // Bytes of the frame from chunk first on (the last chunk unpadded)
+        PacketRef view(size_t first) const;
+        
+        // The chunks slice streaming has not handed out yet, in place
+        CompleteFrame unforwarded() const;
+    };
+    
+    // One slot of the interleaved block ring, reset in place like frame slots
+    struct InterleavedBlock {
+        bool in_use;
+        InterleavedFecHeader header;
+        FecBlock parity;
+        std::chrono::steady_clock::time_point timestamp;
+        
+        InterleavedBlock() : in_use(false) {}
         
-        explicit FrameBuffer(uint16_t total_chunks);
+        void reset(const InterleavedFecHeader& h);
+        void clear();
+    };
+    
+    // One data symbol of an FEC block; frame is null once the frame is gone
+    struct SymbolRef {
+        uint32_t sequence_number;
+        FrameBuffer* frame;
+        uint16_t chunk_id;
     };
     
     uint32_t jitter_buffer_ms_;
+    size_t max_chunk_size_;
     std::atomic<bool> running_{false};
     std::thread collector_thread_;
     mutable std::mutex chunks_mutex_;
+    std::condition_variable stop_cv_;  // collector stopping, or a frame held for reordering
+    
+    // Frames in flight, in slot sequence_number % kFrameSlots. The ring
+    // spans far more frames than the jitter buffer holds, so a slot is only
+    // claimed by a newer frame long after its own frame is gone.
+    static constexpr size_t kFrameSlots = 512;
+    std::vector<FrameBuffer> frame_slots_;
+    size_t active_frames_;
+    bool have_newest_sequence_;
+    uint32_t newest_sequence_;  // Newest frame that claimed a slot
+    
+    // Assembled frames for the consumer; pushes are serialized by chunks_mutex_
+    static constexpr size_t kReadyFrameCapacity = 256;
+    SpscRing<CompleteFrame> ready_frames_;
+    std::atomic<uint64_t> dropped_frames_;
+    
+    // Slice streaming: at most one frame is handed out piecewise at a time,
+    // and never one older than a frame already handed out
+    bool slice_streaming_;
+    bool streaming_active_;
+    uint32_t streaming_sequence_;
+    bool have_next_sequence_;
+    uint32_t next_sequence_;  // One past the newest frame handed out
+    
+    // Complete frames waiting for their playout time or for older frames
+    // stay in their slot (FrameBuffer::held) and are found by walking the
+    // ring from next_sequence_
+    uint32_t reorder_window_ms_;
+    size_t held_frames_;
+    
+    bool adaptive_playout_;
+    JitterEstimator jitter_estimator_;
+    
+    bool nack_enabled_;
+    NackGenerator nack_generator_;
+    uint64_t retransmitted_chunks_;
+    
+    // Interleaved blocks in flight, in slot block_id % kInterleavedSlots;
+    // the sender numbers blocks consecutively, so a slot is only claimed
+    // again long after its block has left the jitter buffer
+    using BlockKey = std::pair<uint32_t, uint16_t>;  // base sequence, block id
+    static constexpr size_t kInterleavedSlots = 1024;
+    std::vector<InterleavedBlock> interleaved_slots_;
+    
+    // One coder per (k, r) seen on the wire
+    std::map<std::pair<int, int>, std::unique_ptr<ErasureCoder>> coders_;
+    uint64_t recovered_chunks_;
+    uint64_t duplicate_chunks_;
     
-    std::map<uint32_t, std::unique_ptr<FrameBuffer>> frame_buffers_;
-    std::vector<uint32_t> complete_frames_;
+    // Working arrays of recover_symbols(), sized for the largest k + r so
+    // recovery attempts on every chunk arrival do not allocate
+    static constexpr size_t kMaxFecSymbols = 256;  // k + r of a GF(2^8) code
+    std::vector<SymbolRef> recovery_members_;
+    std::vector<int> recovery_missing_;
+    std::vector<std::vector<uint8_t>> recovery_scratch_;  // padded copies, grown to the symbol size once
+    std::vector<uint8_t*> recovery_symbols_;
+    std::vector<int> recovery_erasures_;
     
     // Internal methods
     void collector_loop();
     void cleanup_old_frames();
+    FrameBuffer* get_frame_buffer(uint32_t sequence_number, uint16_t total_chunks);
+    FrameBuffer* find_frame(uint32_t sequence_number);
+    FrameBuffer* oldest_pending_frame(uint32_t before);
+    const FrameBuffer* oldest_pending_frame(uint32_t before) const;
+    FrameBuffer* oldest_held_frame();
+    const FrameBuffer* oldest_held_frame() const;
+    InterleavedBlock* find_interleaved_block(const BlockKey& key);
+    void release_slot(FrameBuffer& frame_buffer);
+    void insert_chunk(const DataHeader& header, bool has_timestamp, ConstByteSpan chunk);
+    void check_complete(uint32_t sequence_number, FrameBuffer& frame_buffer);
+    bool playout_time(const FrameBuffer& frame_buffer, std::chrono::steady_clock::time_point& playout) const;
+    std::chrono::steady_clock::time_point frame_deadline(const FrameBuffer& frame_buffer) const;
+    std::chrono::steady_clock::time_point next_wake_time(std::chrono::steady_clock::time_point limit) const;
+    void release_frame(CompleteFrame&& frame);
+    void release_held_frames();
+    void forward_prefix(uint32_t sequence_number, FrameBuffer& frame_buffer);
+    void end_stream(uint32_t sequence_number);
+    void start_next_stream();
+    void try_recover(uint32_t sequence_number, FrameBuffer& frame_buffer, uint16_t block_id);
+    void try_recover_interleaved(const BlockKey& key);
+    void recover_symbols(const std::vector<SymbolRef>& members, int k, int r,
+                         size_t symbol_size, FecBlock& block);
+    ErasureCoder* get_coder(int k, int r);
 };
\ No newline at end of file
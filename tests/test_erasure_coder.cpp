@@ -1 +1,188 @@
-// FEC modülü için birim testleri 
\ No newline at end of file
+// FEC modülü için birim testleri
+#include "media/erasure_coder.h"
+#include "media/gf256.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond, ...)                                                   \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            failures++;                                                    \
+            std::fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            std::fprintf(stderr, __VA_ARGS__);                             \
+            std::fprintf(stderr, "\n");                                    \
+        }                                                                  \
+    } while (0)
+
+std::mt19937 rng(12345);
+
+std::vector<uint8_t> random_bytes(size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (auto& b : bytes) {
+        b = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+// Region kernels must agree with byte-wise GF256::mul for every length
+// (vector body plus scalar tail) and any alignment of source and destination
+void test_region_kernels() {
+    const size_t lengths[] = {0, 1, 7, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 255, 1000, 1023};
+    const uint8_t constants[] = {0, 1, 2, 0x1D, 0x80, 0xA7, 0xFF};
+    const GF256::Kernel initial = GF256::kernel();
+
+    for (GF256::Kernel kernel : {GF256::SCALAR, GF256::SSSE3, GF256::AVX2}) {
+        GF256::set_kernel(kernel);
+        if (GF256::kernel() != kernel) {
+            std::printf("  %d kernel'i bu CPU'da yok, atlandı\n", static_cast<int>(kernel));
+            continue;
+        }
+
+        for (size_t len : lengths) {
+            for (size_t src_offset : {0, 1, 3, 13}) {
+                for (size_t dst_offset : {0, 5, 16}) {
+                    for (uint8_t c : constants) {
+                        std::vector<uint8_t> src = random_bytes(len + src_offset);
+                        std::vector<uint8_t> dst = random_bytes(len + dst_offset);
+                        const uint8_t* s = src.data() + src_offset;
+                        uint8_t* d = dst.data() + dst_offset;
+
+                        std::vector<uint8_t> expected(d, d + len);
+                        for (size_t i = 0; i < len; ++i) {
+                            expected[i] ^= GF256::mul(c, s[i]);
+                        }
+                        GF256::mul_add_region(d, s, c, len);
+                        CHECK(len == 0 || std::memcmp(d, expected.data(), len) == 0,
+                              "mul_add_region %s len=%zu c=%d src+%zu dst+%zu",
+                              GF256::kernel_name(), len, c, src_offset, dst_offset);
+
+                        for (size_t i = 0; i < len; ++i) {
+                            expected[i] = GF256::mul(c, s[i]);
+                        }
+                        GF256::mul_region(d, s, c, len);
+                        CHECK(len == 0 || std::memcmp(d, expected.data(), len) == 0,
+                              "mul_region %s len=%zu c=%d src+%zu dst+%zu",
+                              GF256::kernel_name(), len, c, src_offset, dst_offset);
+                    }
+                }
+            }
+        }
+    }
+
+    GF256::set_kernel(initial);
+}
+
+// Visit every subset of {0..n-1} with at most max_size elements
+template <typename F>
+void for_each_erasure_pattern(int n, int max_size, F&& visit) {
+    for (uint32_t mask = 0; mask < (1u << n); ++mask) {
+        if (__builtin_popcount(mask) > max_size) {
+            continue;
+        }
+        std::vector<int> erasures;
+        for (int i = 0; i < n; ++i) {
+            if (mask & (1u << i)) {
+                erasures.push_back(i);
+            }
+        }
+        visit(erasures);
+    }
+}
+
+// Parity from gathered segments matches encode(), and every pattern of up
+// to r lost symbols decodes back to the zero padded data
+void test_encode_decode() {
+    for (int k = 1; k <= 6; ++k) {
+        for (int r = 1; r <= 3; ++r) {
+            ErasureCoder coder(ErasureCoder::CodingParams(k, r), 4);
+
+            const size_t data_size = 1 + rng() % 300;
+            std::vector<uint8_t> data = random_bytes(data_size);
+            std::vector<std::vector<uint8_t>> chunks = coder.encode(data);
+            CHECK(chunks.size() == static_cast<size_t>(k + r), "k=%d r=%d", k, r);
+            const size_t symbol_size = chunks[0].size();
+
+            // Same parity when the data arrives in uneven pieces
+            const size_t cut1 = data_size / 3;
+            const size_t cut2 = cut1 + (data_size - cut1) / 2;
+            ConstByteSpan segments[] = {
+                ConstByteSpan(data.data(), cut1),
+                ConstByteSpan(data.data() + cut1, cut2 - cut1),
+                ConstByteSpan(data.data() + cut2, data_size - cut2),
+            };
+            ParityArena arena;
+            CHECK(coder.encode_parity(segments, 3, arena, 0, 7) == symbol_size, "k=%d r=%d", k, r);
+            for (int i = 0; i < r; ++i) {
+                CHECK(std::memcmp(arena.symbol(i), chunks[k + i].data(), symbol_size) == 0,
+                      "gathered parity k=%d r=%d i=%d", k, r, i);
+            }
+
+            std::vector<uint8_t> padded(data);
+            padded.resize(k * symbol_size, 0);
+
+            for_each_erasure_pattern(k + r, r, [&](const std::vector<int>& erasures) {
+                std::vector<std::vector<uint8_t>*> available(k + r);
+                for (int i = 0; i < k + r; ++i) {
+                    available[i] = &chunks[i];
+                }
+                for (int e : erasures) {
+                    available[e] = nullptr;
+                }
+                std::vector<uint8_t> decoded = coder.decode(available, erasures);
+                CHECK(decoded == padded, "decode k=%d r=%d losses=%zu", k, r, erasures.size());
+            });
+
+            // A pattern seen before is served from the cache, which stays
+            // within its capacity plus the precomputed single losses
+            for_each_erasure_pattern(k + r, r, [&](const std::vector<int>& erasures) {
+                std::vector<uint8_t*> symbols(k + r);
+                std::vector<std::vector<uint8_t>> copy(chunks);
+                for (int i = 0; i < k + r; ++i) {
+                    symbols[i] = copy[i].data();
+                }
+                for (int e : erasures) {
+                    std::memset(copy[e].data(), 0, symbol_size);
+                }
+                uint64_t hits = coder.get_cache_hits();
+                CHECK(coder.reconstruct(symbols, erasures, symbol_size), "k=%d r=%d", k, r);
+                CHECK(coder.reconstruct(symbols, erasures, symbol_size), "k=%d r=%d", k, r);
+                for (int j = 0; j < k; ++j) {
+                    CHECK(copy[j] == chunks[j], "reconstruct k=%d r=%d column=%d", k, r, j);
+                }
+                bool needs_plan = false;
+                for (int e : erasures) {
+                    needs_plan = needs_plan || e < k;
+                }
+                CHECK(!needs_plan || coder.get_cache_hits() > hits, "cache k=%d r=%d", k, r);
+                CHECK(coder.get_cache_size() <= 4 + static_cast<size_t>(k), "cache size k=%d r=%d", k, r);
+            });
+
+            // More losses than parity cannot be decoded
+            std::vector<int> too_many;
+            for (int i = 0; i <= r; ++i) {
+                too_many.push_back(i);
+            }
+            CHECK(!coder.can_decode(too_many), "k=%d r=%d", k, r);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_region_kernels();
+    test_encode_decode();
+
+    if (failures > 0) {
+        std::printf("test_erasure_coder: %d hata\n", failures);
+        return 1;
+    }
+    std::printf("test_erasure_coder: tamam\n");
+    return 0;
+}
@@ -0,0 +1,217 @@
+// Packet pool modülü için birim testleri
+#include "common/packet_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond, ...)                                                   \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            failures++;                                                    \
+            std::fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            std::fprintf(stderr, __VA_ARGS__);                             \
+            std::fprintf(stderr, "\n");                                    \
+        }                                                                  \
+    } while (0)
+
+void test_invalid_parameters() {
+    for (auto params : {std::make_pair<size_t, size_t>(0, 4), std::make_pair<size_t, size_t>(100, 0)}) {
+        bool threw = false;
+        try {
+            PacketPool pool(params.first, params.second);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        CHECK(threw, "size %zu count %zu", params.first, params.second);
+    }
+}
+
+// Every buffer can be taken once; the next acquire fails and is counted,
+// and a dropped buffer is handed out again
+void test_exhaustion_and_recycle() {
+    PacketPool pool(100, 4);
+    std::vector<PacketRef> held;
+    for (int i = 0; i < 4; ++i) {
+        PacketRef packet = pool.acquire();
+        CHECK(packet && packet.size() == 100, "acquire %d", i);
+        CHECK(reinterpret_cast<uintptr_t>(packet.data()) % PacketPool::kAlignment == 0,
+              "buffer %d not aligned", i);
+        held.push_back(std::move(packet));
+    }
+    CHECK(pool.get_available_count() == 0, "available %zu", pool.get_available_count());
+
+    PacketRef none = pool.acquire();
+    CHECK(!none && none.empty() && none.data() == nullptr, "acquire from an exhausted pool");
+    CHECK(pool.get_exhausted_count() == 1, "exhausted %llu",
+          static_cast<unsigned long long>(pool.get_exhausted_count()));
+    CHECK(!pool.copy(ConstByteSpan(held[0].data(), 10)), "copy from an exhausted pool");
+
+    const uint8_t* recycled = held[2].data();
+    held[2].reset();
+    CHECK(pool.get_available_count() == 1, "available %zu", pool.get_available_count());
+    PacketRef again = pool.acquire();
+    CHECK(again && again.data() == recycled, "recycled buffer not reused");
+    CHECK(pool.get_available_count() == 0, "available %zu", pool.get_available_count());
+
+    held.clear();
+    again.reset();
+    CHECK(pool.get_available_count() == 4, "available %zu", pool.get_available_count());
+}
+
+void test_copy() {
+    PacketPool pool(16, 2);
+    const uint8_t bytes[] = {1, 2, 3, 4, 5};
+    PacketRef packet = pool.copy(ConstByteSpan(bytes, sizeof(bytes)));
+    CHECK(packet && packet.size() == sizeof(bytes), "copy size %zu", packet.size());
+    CHECK(std::memcmp(packet.data(), bytes, sizeof(bytes)) == 0, "copy bytes");
+
+    // Too large for a buffer: refused without taking one
+    std::vector<uint8_t> large(17, 9);
+    CHECK(!pool.copy(ConstByteSpan(large)), "oversized copy");
+    CHECK(pool.get_available_count() == 1, "available %zu", pool.get_available_count());
+
+    // resize() is capped at the capacity
+    packet.resize(1000);
+    CHECK(packet.size() == 16, "size %zu", packet.size());
+}
+
+// Subviews and copies share the buffer; it goes back to the pool only when
+// the last of them is dropped
+void test_refcounting() {
+    PacketPool pool(64, 1);
+    PacketRef packet = pool.acquire();
+    for (size_t i = 0; i < 64; ++i) {
+        packet.mutable_data()[i] = static_cast<uint8_t>(i);
+    }
+    packet.resize(40);
+    CHECK(packet.unique(), "fresh buffer shared");
+
+    PacketRef payload = packet.subview(8);
+    CHECK(payload.size() == 32 && payload.data()[0] == 8, "subview size %zu", payload.size());
+    CHECK(!packet.unique() && !payload.unique(), "subview does not share the buffer");
+
+    PacketRef inner = payload.subview(4, 10);
+    CHECK(inner.size() == 10 && inner.data()[0] == 12, "nested subview size %zu", inner.size());
+    PacketRef past_end = payload.subview(100);
+    CHECK(past_end.empty() && past_end, "subview past the end size %zu", past_end.size());
+
+    packet.reset();
+    payload.reset();
+    past_end.reset();
+    CHECK(pool.get_available_count() == 0, "buffer recycled while a subview holds it");
+    CHECK(inner.unique() && inner.data()[9] == 21, "subview lost its bytes");
+
+    // Copies add a reference, moves hand it over
+    PacketRef copy(inner);
+    PacketRef assigned;
+    assigned = copy;
+    CHECK(!inner.unique() && assigned.data() == inner.data(), "copies do not share the buffer");
+
+    PacketRef moved(std::move(copy));
+    CHECK(!copy && copy.size() == 0, "moved-from handle kept the buffer");
+    PacketRef move_assigned;
+    move_assigned = std::move(moved);
+    CHECK(!moved && move_assigned.size() == 10, "move assignment");
+
+    // Self assignment keeps the reference
+    assigned = *&assigned;
+    CHECK(assigned && assigned.data() == inner.data(), "self assignment");
+
+    inner.reset();
+    assigned.reset();
+    CHECK(pool.get_available_count() == 0, "buffer recycled while a copy holds it");
+    CHECK(move_assigned.unique(), "last handle not unique");
+
+    // Assigning over the last handle releases the buffer
+    move_assigned = PacketRef();
+    CHECK(pool.get_available_count() == 1, "available %zu", pool.get_available_count());
+    CHECK(pool.acquire(), "buffer not recycled");
+}
+
+// Heap buffers follow the same rules without a pool
+void test_heap_buffers() {
+    const uint8_t bytes[] = {7, 8, 9};
+    PacketRef packet = PacketRef::copy_of(ConstByteSpan(bytes, sizeof(bytes)));
+    PacketRef view = packet.subview(1);
+    packet.reset();
+    CHECK(view.size() == 2 && view.data()[0] == 8 && view.unique(), "heap subview");
+
+    PacketRef buffer = PacketRef::allocate(32);
+    CHECK(buffer && buffer.empty() && buffer.capacity() == 32, "allocate");
+    buffer.resize(32);
+    CHECK(buffer.size() == 32, "resize %zu", buffer.size());
+}
+
+// Threads acquire, share and drop buffers concurrently; none is lost or
+// handed out twice
+void test_threads() {
+    const size_t count = 64;
+    PacketPool pool(32, count);
+    std::atomic<int> corrupted(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool, &corrupted, t] {
+            std::vector<PacketRef> held;
+            for (int i = 0; i < 100000; ++i) {
+                PacketRef packet = pool.acquire();
+                if (packet) {
+                    std::memset(packet.mutable_data(), t, 32);
+                    held.push_back(packet.subview(4));
+                }
+                if (held.size() > 8 || (!packet && !held.empty())) {
+                    for (const auto& view : held) {
+                        if (view.data()[0] != t) {
+                            corrupted++;
+                        }
+                    }
+                    held.clear();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(corrupted == 0, "%d views saw another thread's bytes", corrupted.load());
+    CHECK(pool.get_available_count() == count, "available %zu of %zu", pool.get_available_count(), count);
+
+    std::vector<PacketRef> all;
+    for (size_t i = 0; i < count; ++i) {
+        all.push_back(pool.acquire());
+    }
+    bool distinct = true;
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = i + 1; j < count; ++j) {
+            distinct = distinct && all[i] && all[i].data() != all[j].data();
+        }
+    }
+    CHECK(distinct, "buffer handed out twice");
+    CHECK(!pool.acquire(), "more buffers than the pool holds");
+}
+
+} // namespace
+
+int main() {
+    test_invalid_parameters();
+    test_exhaustion_and_recycle();
+    test_copy();
+    test_refcounting();
+    test_heap_buffers();
+    test_threads();
+
+    if (failures > 0) {
+        std::printf("test_packet_pool: %d hata\n", failures);
+        return 1;
+    }
+    std::printf("test_packet_pool: tamam\n");
+    return 0;
+}
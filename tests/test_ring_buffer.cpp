@@ -0,0 +1,272 @@
+// Ring buffer modülü için birim testleri
+#include "common/ring_buffer.h"
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond, ...)                                                   \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            failures++;                                                    \
+            std::fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, #cond); \
+            std::fprintf(stderr, __VA_ARGS__);                             \
+            std::fprintf(stderr, "\n");                                    \
+        }                                                                  \
+    } while (0)
+
+// Capacity rounds up to a power of two, and nonsense sizes are rejected
+void test_capacity() {
+    CHECK(ring_capacity_for(1) == 1, "1");
+    CHECK(ring_capacity_for(3) == 4, "3");
+    CHECK(ring_capacity_for(64) == 64, "64");
+    CHECK(ring_capacity_for(65) == 128, "65");
+
+    bool threw = false;
+    try {
+        ring_capacity_for(0);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw, "capacity 0");
+}
+
+// A ring takes exactly capacity values, rejects the next one and gives
+// nothing back once drained
+template <typename Ring>
+void check_boundaries(Ring& ring, const char* name) {
+    const size_t capacity = ring.capacity();
+    int value = 0;
+    CHECK(ring.empty() && !ring.try_pop(value), "%s: new ring not empty", name);
+
+    for (size_t i = 0; i < capacity; ++i) {
+        CHECK(ring.try_push(static_cast<int>(i)), "%s: push %zu of %zu", name, i, capacity);
+    }
+    CHECK(ring.size() == capacity, "%s: size %zu", name, ring.size());
+    CHECK(!ring.try_push(-1), "%s: push into a full ring", name);
+
+    // One pop frees exactly one slot
+    CHECK(ring.try_pop(value) && value == 0, "%s: pop %d", name, value);
+    CHECK(ring.try_push(static_cast<int>(capacity)), "%s: push after pop", name);
+    CHECK(!ring.try_push(-1), "%s: full again", name);
+
+    for (size_t i = 1; i <= capacity; ++i) {
+        CHECK(ring.try_pop(value) && value == static_cast<int>(i), "%s: pop %zu got %d", name, i, value);
+    }
+    CHECK(ring.empty() && !ring.try_pop(value), "%s: drained ring not empty", name);
+}
+
+// Indices keep counting past the capacity; slots are reused in order for
+// many laps, in batches that straddle the end of the slot array
+template <typename Ring>
+void check_wraparound(Ring& ring, const char* name) {
+    const size_t capacity = ring.capacity();
+    const size_t batch = capacity / 2 + 1;
+    std::vector<int> in(batch);
+    std::vector<int> out(capacity);
+    int next_in = 0;
+    int next_out = 0;
+
+    for (size_t lap = 0; lap < 100 * capacity; lap += batch) {
+        for (size_t i = 0; i < batch; ++i) {
+            in[i] = next_in + static_cast<int>(i);
+        }
+        size_t pushed = ring.try_push_batch(in.data(), batch);
+        CHECK(pushed == batch, "%s: pushed %zu of %zu", name, pushed, batch);
+        next_in += static_cast<int>(pushed);
+
+        size_t popped = ring.try_pop_batch(out.data(), capacity);
+        CHECK(popped == pushed, "%s: popped %zu of %zu", name, popped, pushed);
+        for (size_t i = 0; i < popped; ++i) {
+            CHECK(out[i] == next_out, "%s: got %d expected %d", name, out[i], next_out);
+            next_out++;
+        }
+    }
+    CHECK(ring.empty(), "%s: not empty after laps", name);
+}
+
+void test_spsc() {
+    SpscRing<int> ring(5);
+    CHECK(ring.capacity() == 8, "capacity %zu", ring.capacity());
+    check_boundaries(ring, "spsc");
+    check_wraparound(ring, "spsc");
+
+    // A batch larger than the free space is cut to fit
+    std::vector<int> values(12, 7);
+    CHECK(ring.try_push_batch(values.data(), values.size()) == 8, "partial batch");
+    int value = 0;
+    CHECK(!ring.push_wait(value, std::chrono::milliseconds(1)), "push_wait on a full ring");
+    while (ring.try_pop(value)) {
+    }
+    CHECK(!ring.pop_wait(value, std::chrono::milliseconds(1)), "pop_wait on an empty ring");
+}
+
+void test_spsc_threads() {
+    SpscRing<uint64_t> ring(16);
+    const uint64_t count = 1000000;
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t value = i;
+            while (!ring.push_wait(value, std::chrono::milliseconds(10))) {
+            }
+        }
+    });
+
+    uint64_t expected = 0;
+    bool in_order = true;
+    while (expected < count) {
+        uint64_t value;
+        if (ring.pop_wait(value, std::chrono::milliseconds(10))) {
+            in_order = in_order && value == expected;
+            expected++;
+        }
+    }
+    producer.join();
+    CHECK(in_order, "spsc values out of order");
+    CHECK(ring.empty(), "spsc ring not empty");
+}
+
+void test_mpsc() {
+    MpscRing<int> ring(4);
+    check_boundaries(ring, "mpsc");
+    check_wraparound(ring, "mpsc");
+}
+
+// Producers race for slots; every value arrives exactly once and each
+// producer's values arrive in the order it pushed them
+void test_mpsc_stress() {
+    const int producers = 4;
+    const uint32_t per_producer = 250000;
+    MpscRing<uint64_t> ring(64);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p, per_producer] {
+            for (uint32_t i = 0; i < per_producer; ++i) {
+                uint64_t value = static_cast<uint64_t>(p) << 32 | i;
+                while (!ring.try_push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> next(producers, 0);
+    uint64_t received = 0;
+    bool in_order = true;
+    while (received < static_cast<uint64_t>(producers) * per_producer) {
+        uint64_t values[32];
+        size_t popped = ring.try_pop_batch(values, 32);
+        if (popped == 0) {
+            ring.wait_for_data(std::chrono::milliseconds(10));
+            continue;
+        }
+        for (size_t i = 0; i < popped; ++i) {
+            int p = static_cast<int>(values[i] >> 32);
+            uint32_t sequence = static_cast<uint32_t>(values[i]);
+            if (p >= producers || sequence != next[p]) {
+                in_order = false;
+            } else {
+                next[p]++;
+            }
+        }
+        received += popped;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(in_order, "mpsc values lost, repeated or out of order");
+    for (int p = 0; p < producers; ++p) {
+        CHECK(next[p] == per_producer, "producer %d: %u of %u", p, next[p], per_producer);
+    }
+    CHECK(ring.empty(), "mpsc ring not empty");
+}
+
+// A full ring evicts its oldest value, so the newest always gets in
+void test_overwrite() {
+    OverwriteRing<std::string> ring(3);
+    CHECK(ring.capacity() == 4, "capacity %zu", ring.capacity());
+    for (int i = 0; i < 4; ++i) {
+        CHECK(ring.push(std::to_string(i)) == 0, "push %d evicted", i);
+    }
+    CHECK(ring.push("4") == 1, "push into a full ring");
+    CHECK(ring.push("5") == 1, "push into a full ring");
+    CHECK(ring.size() == 4, "size %zu", ring.size());
+
+    std::string values[8];
+    size_t popped = ring.try_pop_batch(values, 8);
+    CHECK(popped == 4, "popped %zu", popped);
+    for (size_t i = 0; i < popped; ++i) {
+        CHECK(values[i] == std::to_string(i + 2), "got %s", values[i].c_str());
+    }
+    CHECK(ring.empty(), "not empty");
+
+    // Many laps past the capacity
+    for (int i = 0; i < 1000; ++i) {
+        ring.push(std::to_string(i));
+    }
+    std::string value;
+    int expected = 996;
+    while (ring.try_pop(value)) {
+        CHECK(value == std::to_string(expected), "got %s expected %d", value.c_str(), expected);
+        expected++;
+    }
+    CHECK(expected == 1000, "last %d", expected);
+}
+
+// The producer evicts while the consumer pops: nothing is seen twice or
+// out of order, every value is either popped or evicted, and the last one
+// always arrives
+void test_overwrite_threads() {
+    OverwriteRing<uint64_t> ring(2);
+    const uint64_t count = 500000;
+    uint64_t evicted = 0;
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= count; ++i) {
+            evicted += ring.push(i);
+        }
+    });
+
+    uint64_t last = 0;
+    uint64_t popped = 0;
+    bool in_order = true;
+    while (last < count) {
+        uint64_t value;
+        if (ring.try_pop(value)) {
+            in_order = in_order && value > last;
+            last = value;
+            popped++;
+        }
+    }
+    producer.join();
+    CHECK(in_order, "overwrite values out of order");
+    CHECK(popped + evicted == count, "popped %llu + evicted %llu != %llu",
+          static_cast<unsigned long long>(popped), static_cast<unsigned long long>(evicted),
+          static_cast<unsigned long long>(count));
+}
+
+} // namespace
+
+int main() {
+    test_capacity();
+    test_spsc();
+    test_spsc_threads();
+    test_mpsc();
+    test_mpsc_stress();
+    test_overwrite();
+    test_overwrite_threads();
+
+    if (failures > 0) {
+        std::printf("test_ring_buffer: %d hata\n", failures);
+        return 1;
+    }
+    std::printf("test_ring_buffer: tamam\n");
+    return 0;
+}